@@ -184,6 +184,24 @@ def validate_manifest(pplugin):
     return parse_errors
 
 
+def validate_async(method):
+    params = method.get('paramTypes') or []
+    if not params or params[-1].get('type') != 'function' or 'prototype' not in params[-1]:
+        return 'last parameter must be a function with prototype'
+    prototype = params[-1]['prototype']
+    ret_type = prototype.get('retType')
+    results = prototype.get('paramTypes')
+    if type(ret_type) is not dict or type(results) is not list:
+        return 'completion callback prototype must have retType and paramTypes'
+    if ret_type.get('type') != 'void':
+        return 'completion callback must return void'
+    if len(results) > 1:
+        return 'completion callback must have at most one parameter'
+    if any('ref' in param and param['ref'] is True for param in results):
+        return 'completion callback parameter can not be ref'
+    return None
+
+
 def convert_type(type_name, is_ref=False):
     if is_ref:
         return 'ref ' + TYPES_MAP.get(type_name, 'int')
@@ -234,6 +252,33 @@ def gen_delegate(prototype):
             f'{prototype["name"]}({gen_params_string(prototype["paramTypes"], ParamGen.TypesNames)});\n')
 
 
+def gen_async_wrapper(method):
+    params = method['paramTypes'][:-1]
+    prototype = method['paramTypes'][-1]['prototype']
+    results = prototype['paramTypes']
+    name = method['name'] if method['name'].endswith('Async') else f'{method["name"]}Async'
+    callback_type = generate_name(prototype['name'])
+    if results:
+        result_type = convert_type(results[0]['type'])
+        task_type = f'Task<{result_type}>'
+        source_type = f'NativeTask<{result_type}>'
+    else:
+        task_type = 'Task'
+        source_type = 'NativeTask'
+    args = gen_params_string(params, ParamGen.Names)
+    # Locals use reserved names, exported parameters can be called task or callback
+    args = f'{args}, __callback' if args else '__callback'
+    content = f'\t\tinternal static {task_type} {name}({gen_params_string(params, ParamGen.TypesNames)})\n'
+    content += '\t\t{\n'
+    content += f'\t\t\tvar __task = new {source_type}();\n'
+    content += f'\t\t\t{callback_type} __callback = __task.Complete;\n'
+    content += '\t\t\t__task.Bind(__callback);\n'
+    content += f'\t\t\t{method["name"]}({args});\n'
+    content += '\t\t\treturn __task.Task;\n'
+    content += '\t\t}\n'
+    return content
+
+
 def main(manifest_path, output_dir, override):
     if not os.path.isfile(manifest_path):
         print(f'Manifest file not exists {manifest_path}')
@@ -255,6 +300,11 @@ def main(manifest_path, output_dir, override):
         pplugin = json.load(fd)
 
     parse_errors = validate_manifest(pplugin)
+    for i, method in enumerate(pplugin.get('exportedMethods', [])):
+        if type(method) is dict and method.get('async') is True:
+            error = validate_async(method)
+            if error:
+                parse_errors += [f'root.exportedMethods[{i}] async: {error}']
     if parse_errors:
         print('Parse fail:')
         for error in parse_errors:
@@ -269,6 +319,8 @@ def main(manifest_path, output_dir, override):
     content += 'using System.Numerics;\n'
     content += 'using System.Runtime.CompilerServices;\n'
     content += 'using System.Runtime.InteropServices;\n'
+    content += 'using System.Threading.Tasks;\n'
+    content += 'using Plugify;\n'
     content += '\n'
     content += f'//generated with {link} from {plugin_name} \n'
     content += '\n'
@@ -290,6 +342,8 @@ def main(manifest_path, output_dir, override):
         return_type = convert_type(ret_type['type'], 'ref' in ret_type and ret_type['ref'] is True)
         content += (f'\t\tinternal static extern {return_type} '
                     f'{method["name"]}({gen_params_string(method["paramTypes"], ParamGen.TypesNames)});\n')
+        if method.get('async') is True:
+            content += gen_async_wrapper(method)
     content += '\t}\n'
     content += '}\n'
 
@@ -0,0 +1,25 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Allocations made while marshalling strings, arrays, delegates and boxed return values between native code and C#, enabled by the "allocStats" setting of the language module.
+	/// </summary>
+	public static class AllocStats
+	{
+		/// <summary>
+		/// Managed and native allocation counts and bytes, by value type and by bridge method.
+		/// </summary>
+		/// <returns>Null if allocation statistics are disabled.</returns>
+		public static string GetReport()
+		{
+			return InternalCalls.Core_GetAllocStats();
+		}
+
+		/// <summary>
+		/// Clears the counters of all threads, e.g. to measure a single scenario.
+		/// </summary>
+		public static void Reset()
+		{
+			InternalCalls.Core_ResetAllocStats();
+		}
+	}
+}
@@ -0,0 +1,25 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Per-method call counters and latencies of calls between native code and C#, enabled by the "callStats" setting of the language module.
+	/// </summary>
+	public static class CallStats
+	{
+		/// <summary>
+		/// Table of every exported method, imported method and delegate called so far, sorted by total time.
+		/// </summary>
+		/// <returns>Null if call statistics are disabled.</returns>
+		public static string GetReport()
+		{
+			return InternalCalls.Core_GetCallStats();
+		}
+
+		/// <summary>
+		/// Clears the counters of all threads, e.g. to measure a single scenario.
+		/// </summary>
+		public static void Reset()
+		{
+			InternalCalls.Core_ResetCallStats();
+		}
+	}
+}
@@ -0,0 +1,21 @@
+using System;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Manages native entry points created for delegates passed to native code.
+	/// </summary>
+	public static class Callbacks
+	{
+		/// <summary>
+		/// Unbinds the native entry point from the delegate, for example after unsubscribing from an event.
+		/// Calls through the entry point log an error instead of reaching the delegate. The entry point returns to
+		/// the pool once the delegate is collected, native code must not call it after that.
+		/// </summary>
+		/// <returns>False if no native entry point exists for the delegate.</returns>
+		public static bool Release(Delegate callback)
+		{
+			return callback != null && InternalCalls.Core_ReleaseDelegate(callback);
+		}
+	}
+}
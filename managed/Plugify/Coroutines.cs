@@ -0,0 +1,266 @@
+using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Runtime.CompilerServices;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Suspends a coroutine until the next tick.
+	/// </summary>
+	public sealed class NextFrame
+	{
+		public static readonly NextFrame Instance = new NextFrame();
+
+		public Awaiter GetAwaiter() => new Awaiter(0f);
+
+		/// <summary>
+		/// Resumes an async method from the coroutine tick once the delay has passed.
+		/// </summary>
+		public struct Awaiter : INotifyCompletion
+		{
+			private readonly float _delay;
+
+			internal Awaiter(float delay)
+			{
+				_delay = delay;
+			}
+
+			public bool IsCompleted => false;
+
+			public void OnCompleted(Action continuation)
+			{
+				Coroutines.Start(Coroutines.Resume(_delay, continuation));
+			}
+
+			public void GetResult()
+			{
+			}
+		}
+	}
+
+	/// <summary>
+	/// Suspends a coroutine for the given number of seconds of tick time.
+	/// </summary>
+	public sealed class Delay
+	{
+		public float Seconds { get; }
+
+		public Delay(float seconds)
+		{
+			Seconds = seconds;
+		}
+
+		public NextFrame.Awaiter GetAwaiter() => new NextFrame.Awaiter(Seconds);
+	}
+
+	/// <summary>
+	/// Handle of a running coroutine.
+	/// </summary>
+	public sealed class Coroutine
+	{
+		internal readonly Stack<IEnumerator> Routines = new Stack<IEnumerator>();
+		internal readonly Plugin Owner;
+		internal readonly int Priority;
+		internal readonly long Order;
+		internal double ResumeTime;
+		internal long LastTick;
+
+		public bool IsRunning { get; internal set; } = true;
+
+		internal Coroutine(IEnumerator routine, Plugin owner, int priority, long order)
+		{
+			Routines.Push(routine);
+			Owner = owner;
+			Priority = priority;
+			Order = order;
+		}
+	}
+
+	/// <summary>
+	/// Runs IEnumerator based coroutines on the main thread, stepped once per tick by the language module.
+	/// Yield null or NextFrame to wait a tick, Delay to wait for tick time, or another IEnumerator to run it to completion.
+	/// </summary>
+	public static class Coroutines
+	{
+		private static readonly List<Coroutine> Running = new List<Coroutine>();
+		// Coroutines may be started from any thread, Pending and _nextOrder are guarded by locking Pending
+		private static readonly List<Coroutine> Pending = new List<Coroutine>();
+		private static readonly Comparison<Coroutine> Order = Compare;
+
+		private static long _nextOrder;
+		private static long _tick;
+		private static double _time;
+
+		/// <summary>
+		/// Wall time coroutines may spend per tick, lower priority coroutines resume on later ticks once it is spent.
+		/// TimeSpan.Zero disables the budget.
+		/// </summary>
+		public static TimeSpan TickBudget { get; set; } = TimeSpan.Zero;
+
+		/// <summary>
+		/// Tick time in seconds, the sum of all delta times passed to the update.
+		/// </summary>
+		public static double Time => _time;
+
+		public static int Count
+		{
+			get
+			{
+				lock (Pending)
+				{
+					return Running.Count + Pending.Count;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Starts the coroutine on the next tick, higher priority coroutines are stepped first.
+		/// Safe to call from any thread, for example from an await continuation on a worker.
+		/// </summary>
+		/// <param name="routine">Coroutine body.</param>
+		/// <param name="owner">Plugin whose coroutines are stopped when it ends.</param>
+		/// <param name="priority">Step order within a tick.</param>
+		public static Coroutine Start(IEnumerator routine, Plugin owner = null, int priority = 0)
+		{
+			if (routine == null) throw new ArgumentNullException(nameof(routine));
+			lock (Pending)
+			{
+				var coroutine = new Coroutine(routine, owner, priority, _nextOrder++);
+				Pending.Add(coroutine);
+				return coroutine;
+			}
+		}
+
+		public static void Stop(Coroutine coroutine)
+		{
+			if (coroutine != null)
+			{
+				coroutine.IsRunning = false;
+			}
+		}
+
+		public static void StopAll(Plugin owner)
+		{
+			foreach (Coroutine coroutine in Running)
+			{
+				if (ReferenceEquals(coroutine.Owner, owner))
+					coroutine.IsRunning = false;
+			}
+			lock (Pending)
+			{
+				foreach (Coroutine coroutine in Pending)
+				{
+					if (ReferenceEquals(coroutine.Owner, owner))
+						coroutine.IsRunning = false;
+				}
+			}
+		}
+
+		public static NextFrame NextFrame() => Plugify.NextFrame.Instance;
+
+		public static Delay Delay(float seconds) => new Delay(seconds);
+
+		internal static IEnumerator Resume(float delay, Action continuation)
+		{
+			if (delay > 0f)
+			{
+				yield return new Delay(delay);
+			}
+			else
+			{
+				yield return null;
+			}
+			continuation();
+		}
+
+		internal static void Tick(float deltaTime)
+		{
+			++_tick;
+			_time += deltaTime;
+
+			lock (Pending)
+			{
+				Running.AddRange(Pending);
+				Pending.Clear();
+			}
+
+			if (Running.Count == 0)
+				return;
+
+			// Coroutines skipped by the budget sort ahead of others with the same priority
+			Running.Sort(Order);
+
+			long budget = TickBudget.Ticks * Stopwatch.Frequency / TimeSpan.TicksPerSecond;
+			long start = Stopwatch.GetTimestamp();
+
+			foreach (Coroutine coroutine in Running)
+			{
+				if (!coroutine.IsRunning || coroutine.ResumeTime > _time)
+					continue;
+
+				if (budget > 0 && Stopwatch.GetTimestamp() - start >= budget)
+					break;
+
+				coroutine.LastTick = _tick;
+				Step(coroutine);
+			}
+
+			Running.RemoveAll(coroutine => !coroutine.IsRunning);
+		}
+
+		private static void Step(Coroutine coroutine)
+		{
+			while (coroutine.Routines.Count != 0)
+			{
+				IEnumerator routine = coroutine.Routines.Peek();
+
+				bool moved;
+				try
+				{
+					moved = routine.MoveNext();
+				}
+				catch (Exception e)
+				{
+					InternalCalls.Core_HandleException(e);
+					coroutine.IsRunning = false;
+					return;
+				}
+
+				if (!moved)
+				{
+					// Nested routine finished, continue the parent within the same tick
+					coroutine.Routines.Pop();
+					continue;
+				}
+
+				switch (routine.Current)
+				{
+					case Delay delay:
+						coroutine.ResumeTime = _time + delay.Seconds;
+						return;
+					case IEnumerator nested:
+						coroutine.Routines.Push(nested);
+						continue;
+					default:
+						coroutine.ResumeTime = 0;
+						return;
+				}
+			}
+
+			coroutine.IsRunning = false;
+		}
+
+		private static int Compare(Coroutine lhs, Coroutine rhs)
+		{
+			int result = rhs.Priority.CompareTo(lhs.Priority);
+			if (result != 0)
+				return result;
+			result = lhs.LastTick.CompareTo(rhs.LastTick);
+			if (result != 0)
+				return result;
+			return lhs.Order.CompareTo(rhs.Order);
+		}
+	}
+}
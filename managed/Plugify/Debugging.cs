@@ -0,0 +1,22 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Controls the on-demand Mono debugger support of the language module.
+	/// </summary>
+	public static class Debugging
+	{
+		/// <summary>
+		/// True when debugger symbols are loaded for all plugin assemblies.
+		/// </summary>
+		public static bool IsActive => InternalCalls.Core_IsDebuggingActive();
+
+		/// <summary>
+		/// Loads the deferred debugger symbols when the module runs in lazy debugging mode.
+		/// </summary>
+		/// <returns>False if debugging is disabled in the module settings.</returns>
+		public static bool Activate()
+		{
+			return InternalCalls.Core_ActivateDebugging();
+		}
+	}
+}
@@ -0,0 +1,57 @@
+using System.Runtime.InteropServices;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Garbage collector counters, mirrors the native GcSummary layout.
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct GcSummary
+	{
+		public long Collections;
+		public long MinorCollections;
+		public long MajorCollections;
+		public long PauseP50Ns;
+		public long PauseP99Ns;
+		public long PauseMaxNs;
+		public long PauseTotalNs;
+		/// <summary>
+		/// Collections during the last minute.
+		/// </summary>
+		public double CollectionsPerMinute;
+		public long HeapSize;
+	}
+
+	/// <summary>
+	/// Pauses of the garbage collector, enabled by the "gcMonitor" setting of the language module.
+	/// </summary>
+	public static class GcMonitor
+	{
+		/// <summary>
+		/// Counters since start or the last reset, pause quantiles are accurate to about 12%.
+		/// </summary>
+		/// <returns>Zeroed summary if the GC monitor is disabled.</returns>
+		public static GcSummary GetSummary()
+		{
+			InternalCalls.Core_GetGcSummary(out GcSummary summary);
+			return summary;
+		}
+
+		/// <summary>
+		/// Writes recent pauses as a Chrome trace file (chrome://tracing, Perfetto).
+		/// </summary>
+		/// <returns>False if the GC monitor is disabled or the file could not be written.</returns>
+		public static bool WriteTrace(string path)
+		{
+			return InternalCalls.Core_WriteGcTrace(path);
+		}
+
+		/// <summary>
+		/// Clears recent pauses and counters, e.g. to measure a single scenario.
+		/// </summary>
+		public static void Reset()
+		{
+			InternalCalls.Core_ResetGcStats();
+		}
+	}
+}
@@ -0,0 +1,19 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Managed heap and module memory snapshots, enabled by the "heapSnapshot" setting of the language module.
+	/// </summary>
+	public static class HeapSnapshot
+	{
+		/// <summary>
+		/// Forces a full collection and reports the surviving objects by type and owning plugin, the GC handles held and
+		/// the native memory of the module. The report has one tab separated line per entry in a stable order, so
+		/// snapshots taken at different times can be compared with diff to find the plugin whose memory grows.
+		/// </summary>
+		/// <returns>Null if heap snapshots are disabled or when called off the main thread.</returns>
+		public static string Take()
+		{
+			return InternalCalls.Core_TakeHeapSnapshot();
+		}
+	}
+}
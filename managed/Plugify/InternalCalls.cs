@@ -1,4 +1,5 @@
-﻿using System.Runtime.CompilerServices;
+﻿using System;
+using System.Runtime.CompilerServices;
 
 namespace Plugify
 {
@@ -11,11 +12,71 @@ namespace Plugify
 		internal static extern bool Core_IsModuleLoaded(string name, int version, bool minimum);
 		[MethodImplAttribute(MethodImplOptions.InternalCall)]
 		internal static extern bool Core_IsPluginLoaded(string name, int version, bool minimum);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_ActivateDebugging();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_IsDebuggingActive();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_ReleaseDelegate(Delegate callback);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_HandleException(Exception exception);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Core_GetCallStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_ResetCallStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Core_GetAllocStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_ResetAllocStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_GetGcSummary(out GcSummary summary);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_WriteGcTrace(string path);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_ResetGcStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Core_IsTimeAccountingEnabled();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_EnterPlugin(Plugin plugin, bool fixedUpdate);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_LeavePlugin();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Core_GetTimeStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Core_ResetTimeStats();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Core_TakeHeapSnapshot();
 		#endregion
 
 		#region Plugin
 		[MethodImplAttribute(MethodImplOptions.InternalCall)]
 		internal static extern string Plugin_FindResource(long id, string path);
 		#endregion
+
+		#region Profiler
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Profiler_Start();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Profiler_Stop();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Profiler_IsRunning();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Profiler_GetCollapsedStacks();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern string Profiler_GetSpeedscope();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Profiler_Reset();
+		#endregion
+
+		#region Scheduler
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Scheduler_PostWorker(Action job);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern void Scheduler_PostMain(Action job);
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern bool Scheduler_IsMainThread();
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		internal static extern int Scheduler_GetWorkerCount();
+		#endregion
 	}
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Reflection;
+using System.Threading;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Time spent in the per tick callbacks of a plugin.
+	/// </summary>
+	public struct PluginTiming
+	{
+		public Plugin Plugin;
+		public TimeSpan LastUpdate;
+		public TimeSpan LastFixedUpdate;
+		public TimeSpan TotalUpdate;
+		public long UpdateCount;
+	}
+
+	/// <summary>
+	/// Dispatches OnUpdate(float) and OnFixedUpdate(float) of all started plugins, driven once per tick by the language module.
+	/// Coroutines are stepped after the plugin updates.
+	/// </summary>
+	public static class Lifecycle
+	{
+		private sealed class Entry
+		{
+			public Plugin Plugin;
+			public Action<float> Update;
+			public Action<float> FixedUpdate;
+			public long LastUpdateTicks;
+			public long LastFixedUpdateTicks;
+			public long TotalUpdateTicks;
+			public long UpdateCount;
+		}
+
+		private const BindingFlags Flags = BindingFlags.Instance | BindingFlags.Public | BindingFlags.NonPublic;
+
+		private static readonly List<Entry> Entries = new List<Entry>();
+
+		/// <summary>
+		/// Time of the last tick callbacks of every started plugin.
+		/// </summary>
+		public static PluginTiming[] GetTimings()
+		{
+			var timings = new PluginTiming[Entries.Count];
+			for (int i = 0; i < Entries.Count; ++i)
+			{
+				Entry entry = Entries[i];
+				timings[i] = new PluginTiming
+				{
+					Plugin = entry.Plugin,
+					LastUpdate = ToTimeSpan(entry.LastUpdateTicks),
+					LastFixedUpdate = ToTimeSpan(entry.LastFixedUpdateTicks),
+					TotalUpdate = ToTimeSpan(entry.TotalUpdateTicks),
+					UpdateCount = entry.UpdateCount
+				};
+			}
+			return timings;
+		}
+
+		internal static void Register(Plugin plugin)
+		{
+			Type type = plugin.GetType();
+			var entry = new Entry
+			{
+				Plugin = plugin,
+				Update = Bind(plugin, type.GetMethod("OnUpdate", Flags, null, new[] { typeof(float) }, null)),
+				FixedUpdate = Bind(plugin, type.GetMethod("OnFixedUpdate", Flags, null, new[] { typeof(float) }, null))
+			};
+			Entries.Add(entry);
+		}
+
+		internal static void Unregister(Plugin plugin)
+		{
+			Entries.RemoveAll(entry => ReferenceEquals(entry.Plugin, plugin));
+			Coroutines.StopAll(plugin);
+		}
+
+		internal static void Update(float deltaTime)
+		{
+			for (int i = 0; i < Entries.Count; ++i)
+			{
+				Entry entry = Entries[i];
+				if (entry.Update == null)
+					continue;
+
+				long start = Stopwatch.GetTimestamp();
+				Invoke(entry.Update, deltaTime, entry.Plugin, false);
+				entry.LastUpdateTicks = Stopwatch.GetTimestamp() - start;
+				entry.TotalUpdateTicks += entry.LastUpdateTicks;
+				++entry.UpdateCount;
+			}
+
+			Coroutines.Tick(deltaTime);
+		}
+
+		internal static void FixedUpdate(float deltaTime)
+		{
+			for (int i = 0; i < Entries.Count; ++i)
+			{
+				Entry entry = Entries[i];
+				if (entry.FixedUpdate == null)
+					continue;
+
+				long start = Stopwatch.GetTimestamp();
+				Invoke(entry.FixedUpdate, deltaTime, entry.Plugin, true);
+				entry.LastFixedUpdateTicks = Stopwatch.GetTimestamp() - start;
+			}
+		}
+
+		private static Action<float> Bind(Plugin plugin, MethodInfo method)
+		{
+			if (method == null || method.ReturnType != typeof(void))
+				return null;
+			return (Action<float>)Delegate.CreateDelegate(typeof(Action<float>), plugin, method);
+		}
+
+		private static void Invoke(Action<float> callback, float deltaTime, Plugin plugin, bool fixedUpdate)
+		{
+			bool timed = TimeAccounting.IsEnabled;
+			if (timed)
+				InternalCalls.Core_EnterPlugin(plugin, fixedUpdate);
+
+			// A throwing plugin must not stop the tick for the others
+			try
+			{
+				try
+				{
+					callback(deltaTime);
+				}
+				finally
+				{
+					if (timed)
+						InternalCalls.Core_LeavePlugin();
+				}
+			}
+			catch (ThreadAbortException e)
+			{
+				// Raised by the runaway call watchdog, the abort would otherwise be rethrown past the remaining plugins.
+				// Also caught here when the watchdog fired just as the callback returned and the abort arrives with Leave.
+				InternalCalls.Core_HandleException(e);
+				Thread.ResetAbort();
+			}
+			catch (Exception e)
+			{
+				InternalCalls.Core_HandleException(e);
+			}
+		}
+
+		/// <summary>
+		/// Clears an abort requested by the runaway call watchdog after the aborted export already returned.
+		/// </summary>
+		private static void ResetAbort()
+		{
+			try
+			{
+				if ((Thread.CurrentThread.ThreadState & ThreadState.AbortRequested) != 0)
+					Thread.ResetAbort();
+			}
+			catch (ThreadAbortException)
+			{
+				// The pending abort was raised on entry
+				Thread.ResetAbort();
+			}
+		}
+
+		private static TimeSpan ToTimeSpan(long ticks)
+		{
+			return TimeSpan.FromTicks(ticks * TimeSpan.TicksPerSecond / Stopwatch.Frequency);
+		}
+	}
+}
@@ -0,0 +1,164 @@
+using System;
+using System.Collections.Generic;
+using System.Reflection;
+using System.Reflection.Emit;
+using System.Runtime.InteropServices;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Creates native entry points for exported methods with primitive signatures.
+	/// Native code calls the reverse P/Invoke wrapper generated by the runtime directly, without the generic argument marshalling of the language module.
+	/// </summary>
+	internal static class NativeExports
+	{
+		private static readonly object Lock = new object();
+		private static readonly Dictionary<string, Type> DelegateTypes = new Dictionary<string, Type>();
+		private static readonly List<Delegate> Roots = new List<Delegate>();
+		private static readonly MethodInfo ReportMethod = typeof(NativeExports).GetMethod(nameof(Report), BindingFlags.Static | BindingFlags.NonPublic);
+		private static ModuleBuilder _module;
+
+		/// <summary>
+		/// Targets of exported instance methods, loaded by index from the generated wrappers.
+		/// </summary>
+		internal static readonly List<object> Targets = new List<object>();
+
+		/// <summary>
+		/// Called by the language module once per exported method.
+		/// </summary>
+		/// <param name="method">Exported method.</param>
+		/// <param name="target">Plugin instance for instance methods, otherwise null.</param>
+		/// <returns>Native entry point, valid for the lifetime of the domain.</returns>
+		internal static IntPtr CreateEntryPoint(MethodInfo method, object target)
+		{
+			ParameterInfo[] parameters = method.GetParameters();
+			var types = new Type[parameters.Length];
+			for (int i = 0; i < parameters.Length; ++i)
+			{
+				types[i] = parameters[i].ParameterType;
+			}
+
+			lock (Lock)
+			{
+				Type delegateType = GetDelegateType(method.ReturnType, types);
+				Delegate wrapper = CreateWrapper(method, target, types).CreateDelegate(delegateType);
+				Roots.Add(wrapper);
+				return Marshal.GetFunctionPointerForDelegate(wrapper);
+			}
+		}
+
+		private static DynamicMethod CreateWrapper(MethodInfo method, object target, Type[] types)
+		{
+			var wrapper = new DynamicMethod(method.Name, method.ReturnType, types, method.DeclaringType, true);
+			ILGenerator il = wrapper.GetILGenerator();
+			LocalBuilder result = method.ReturnType != typeof(void) ? il.DeclareLocal(method.ReturnType) : null;
+
+			// Exceptions must not unwind into native frames, report them and return default instead
+			il.BeginExceptionBlock();
+			if (!method.IsStatic)
+			{
+				Targets.Add(target);
+				il.Emit(OpCodes.Ldsfld, typeof(NativeExports).GetField(nameof(Targets), BindingFlags.Static | BindingFlags.NonPublic));
+				il.Emit(OpCodes.Ldc_I4, Targets.Count - 1);
+				il.Emit(OpCodes.Callvirt, typeof(List<object>).GetMethod("get_Item"));
+				il.Emit(OpCodes.Castclass, method.DeclaringType);
+			}
+			for (int i = 0; i < types.Length; ++i)
+			{
+				EmitLoadArgument(il, i);
+			}
+			il.Emit(OpCodes.Call, method);
+			if (result != null)
+			{
+				il.Emit(OpCodes.Stloc, result);
+			}
+			il.BeginCatchBlock(typeof(Exception));
+			il.Emit(OpCodes.Call, ReportMethod);
+			il.EndExceptionBlock();
+			if (result != null)
+			{
+				il.Emit(OpCodes.Ldloc, result);
+			}
+			il.Emit(OpCodes.Ret);
+			return wrapper;
+		}
+
+		private static void EmitLoadArgument(ILGenerator il, int index)
+		{
+			switch (index)
+			{
+				case 0: il.Emit(OpCodes.Ldarg_0); break;
+				case 1: il.Emit(OpCodes.Ldarg_1); break;
+				case 2: il.Emit(OpCodes.Ldarg_2); break;
+				case 3: il.Emit(OpCodes.Ldarg_3); break;
+				default:
+					if (index <= byte.MaxValue)
+						il.Emit(OpCodes.Ldarg_S, (byte)index);
+					else
+						il.Emit(OpCodes.Ldarg, (short)index);
+					break;
+			}
+		}
+
+		private static Type GetDelegateType(Type returnType, Type[] types)
+		{
+			string key = returnType.FullName;
+			for (int i = 0; i < types.Length; ++i)
+			{
+				key += "," + types[i].FullName;
+			}
+
+			if (DelegateTypes.TryGetValue(key, out Type cached))
+				return cached;
+
+			if (_module == null)
+			{
+				AssemblyBuilder assembly = AppDomain.CurrentDomain.DefineDynamicAssembly(new AssemblyName("Plugify.NativeExports"), AssemblyBuilderAccess.Run);
+				_module = assembly.DefineDynamicModule("Plugify.NativeExports");
+			}
+
+			TypeBuilder builder = _module.DefineType($"ExportDelegate{DelegateTypes.Count}", TypeAttributes.Public | TypeAttributes.Sealed | TypeAttributes.AutoClass, typeof(MulticastDelegate));
+			builder.SetCustomAttribute(new CustomAttributeBuilder(typeof(UnmanagedFunctionPointerAttribute).GetConstructor(new[] { typeof(CallingConvention) }), new object[] { CallingConvention.Cdecl }));
+
+			ConstructorBuilder ctor = builder.DefineConstructor(MethodAttributes.RTSpecialName | MethodAttributes.HideBySig | MethodAttributes.Public, CallingConventions.Standard, new[] { typeof(object), typeof(IntPtr) });
+			ctor.SetImplementationFlags(MethodImplAttributes.Runtime | MethodImplAttributes.Managed);
+
+			MethodBuilder invoke = builder.DefineMethod("Invoke", MethodAttributes.Public | MethodAttributes.HideBySig | MethodAttributes.NewSlot | MethodAttributes.Virtual, returnType, types);
+			invoke.SetImplementationFlags(MethodImplAttributes.Runtime | MethodImplAttributes.Managed);
+			for (int i = 0; i <= types.Length; ++i)
+			{
+				Type type = i == 0 ? returnType : types[i - 1];
+				if (type.IsByRef)
+				{
+					type = type.GetElementType();
+				}
+
+				ParameterBuilder parameter = invoke.DefineParameter(i, ParameterAttributes.None, i == 0 ? null : $"arg{i}");
+				if (type == typeof(bool))
+				{
+					parameter.SetCustomAttribute(MarshalAs(UnmanagedType.U1));
+				}
+				else if (type == typeof(char))
+				{
+					// Only char16 exports take this path
+					parameter.SetCustomAttribute(MarshalAs(UnmanagedType.U2));
+				}
+			}
+
+			Type delegateType = builder.CreateType();
+			DelegateTypes.Add(key, delegateType);
+			return delegateType;
+		}
+
+		private static CustomAttributeBuilder MarshalAs(UnmanagedType type)
+		{
+			return new CustomAttributeBuilder(typeof(MarshalAsAttribute).GetConstructor(new[] { typeof(UnmanagedType) }), new object[] { type });
+		}
+
+		private static void Report(Exception e)
+		{
+			// Logged like exceptions of exports called through the generic path
+			InternalCalls.Core_HandleException(e);
+		}
+	}
+}
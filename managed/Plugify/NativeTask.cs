@@ -0,0 +1,82 @@
+using System;
+using System.Collections.Generic;
+using System.Threading.Tasks;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Keeps completion callbacks of asynchronous native exports alive until the native side invokes them.
+	/// </summary>
+	public abstract class NativeTaskBase
+	{
+		private static readonly HashSet<NativeTaskBase> Pending = new HashSet<NativeTaskBase>();
+
+		private Delegate _callback;
+
+		/// <summary>
+		/// Roots the completion callback which is passed to the native export.
+		/// </summary>
+		public void Bind(Delegate callback)
+		{
+			_callback = callback;
+			lock (Pending)
+			{
+				Pending.Add(this);
+			}
+		}
+
+		protected void Finish(Action complete)
+		{
+			lock (Pending)
+			{
+				Pending.Remove(this);
+			}
+
+			if (_callback != null)
+			{
+				Callbacks.Release(_callback);
+				_callback = null;
+			}
+
+			// Continuations always run on the main thread, whichever thread the native side completes from
+			if (Scheduler.IsMainThread)
+			{
+				complete();
+			}
+			else
+			{
+				Scheduler.RunOnMainThread(complete);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Task completed by the native side of an asynchronous export without a result.
+	/// </summary>
+	public sealed class NativeTask : NativeTaskBase
+	{
+		private readonly TaskCompletionSource<bool> _source = new TaskCompletionSource<bool>();
+
+		public Task Task => _source.Task;
+
+		public void Complete()
+		{
+			Finish(() => _source.TrySetResult(true));
+		}
+	}
+
+	/// <summary>
+	/// Task completed with the result passed by the native side of an asynchronous export.
+	/// </summary>
+	public sealed class NativeTask<T> : NativeTaskBase
+	{
+		private readonly TaskCompletionSource<T> _source = new TaskCompletionSource<T>();
+
+		public Task<T> Task => _source.Task;
+
+		public void Complete(T result)
+		{
+			Finish(() => _source.TrySetResult(result));
+		}
+	}
+}
@@ -0,0 +1,56 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Sampling profiler of managed call stacks, aggregated per plugin. Available when the "samplingFrequency" setting of the language module is not zero.
+	/// </summary>
+	public static class Profiler
+	{
+		/// <summary>
+		/// True while stacks are being sampled, sampling starts with the language module.
+		/// </summary>
+		public static bool IsRunning => InternalCalls.Profiler_IsRunning();
+
+		/// <summary>
+		/// Resumes sampling after Stop.
+		/// </summary>
+		/// <returns>False if sampling is disabled or already running.</returns>
+		public static bool Start()
+		{
+			return InternalCalls.Profiler_Start();
+		}
+
+		/// <summary>
+		/// Pauses sampling, collected stacks are kept.
+		/// </summary>
+		public static void Stop()
+		{
+			InternalCalls.Profiler_Stop();
+		}
+
+		/// <summary>
+		/// Folded stacks as "plugin;outer;...;inner count" lines, for flamegraph.pl or speedscope.
+		/// </summary>
+		/// <returns>Null if sampling is disabled.</returns>
+		public static string GetCollapsedStacks()
+		{
+			return InternalCalls.Profiler_GetCollapsedStacks();
+		}
+
+		/// <summary>
+		/// Speedscope JSON with one profile per plugin.
+		/// </summary>
+		/// <returns>Null if sampling is disabled.</returns>
+		public static string GetSpeedscope()
+		{
+			return InternalCalls.Profiler_GetSpeedscope();
+		}
+
+		/// <summary>
+		/// Drops collected stacks, e.g. to profile a single scenario.
+		/// </summary>
+		public static void Reset()
+		{
+			InternalCalls.Profiler_Reset();
+		}
+	}
+}
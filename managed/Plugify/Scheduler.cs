@@ -0,0 +1,61 @@
+using System;
+using System.Threading.Tasks;
+
+namespace Plugify
+{
+	/// <summary>
+	/// Moves plugin work between the language module worker pool and the main thread.
+	/// </summary>
+	public static class Scheduler
+	{
+		/// <summary>
+		/// True on the thread which runs plugin callbacks and pumps the main thread queue.
+		/// </summary>
+		public static bool IsMainThread => InternalCalls.Scheduler_IsMainThread();
+
+		/// <summary>
+		/// Number of threads in the worker pool.
+		/// </summary>
+		public static int WorkerCount => InternalCalls.Scheduler_GetWorkerCount();
+
+		/// <summary>
+		/// Queues the job on the worker pool, native exports must not be called from it unless they are thread safe.
+		/// </summary>
+		public static void RunOnWorker(Action job)
+		{
+			if (job == null) throw new ArgumentNullException(nameof(job));
+			InternalCalls.Scheduler_PostWorker(job);
+		}
+
+		/// <summary>
+		/// Queues the job for the next main thread pump, can be called from any thread.
+		/// </summary>
+		public static void RunOnMainThread(Action job)
+		{
+			if (job == null) throw new ArgumentNullException(nameof(job));
+			InternalCalls.Scheduler_PostMain(job);
+		}
+
+		/// <summary>
+		/// Runs the function on the worker pool, the returned task completes on the main thread.
+		/// </summary>
+		public static Task<T> RunOnWorker<T>(Func<T> func)
+		{
+			if (func == null) throw new ArgumentNullException(nameof(func));
+			var source = new TaskCompletionSource<T>();
+			RunOnWorker(() =>
+			{
+				try
+				{
+					T result = func();
+					RunOnMainThread(() => source.SetResult(result));
+				}
+				catch (Exception e)
+				{
+					RunOnMainThread(() => source.SetException(e));
+				}
+			});
+			return source.Task;
+		}
+	}
+}
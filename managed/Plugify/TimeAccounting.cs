@@ -0,0 +1,31 @@
+namespace Plugify
+{
+	/// <summary>
+	/// Managed time spent in each plugin through exports, delegates and lifecycle callbacks, enabled by the "timeAccounting" setting of the language module.
+	/// Calls into another plugin are charged to that plugin.
+	/// </summary>
+	public static class TimeAccounting
+	{
+		/// <summary>
+		/// Whether the language module accounts plugin time, fixed for the lifetime of the runtime.
+		/// </summary>
+		public static readonly bool IsEnabled = InternalCalls.Core_IsTimeAccountingEnabled();
+
+		/// <summary>
+		/// Total time per plugin and call kind, the last and longest tick and the number of budget overruns.
+		/// </summary>
+		/// <returns>Null if time accounting is disabled.</returns>
+		public static string GetReport()
+		{
+			return InternalCalls.Core_GetTimeStats();
+		}
+
+		/// <summary>
+		/// Clears the counters of all plugins.
+		/// </summary>
+		public static void Reset()
+		{
+			InternalCalls.Core_ResetTimeStats();
+		}
+	}
+}
@@ -0,0 +1,139 @@
+#include "alloc_stats.h"
+
+#include <algorithm>
+
+using namespace monolm;
+
+namespace {
+	thread_local const void* g_currentSite = nullptr;
+}
+
+AllocStats::Scope::Scope(AllocStats& stats, const void* site, CallKind kind, plugify::MethodRef method) : _active{stats.IsEnabled()} {
+	if (!_active)
+		return;
+
+	_previous = g_currentSite;
+	g_currentSite = site;
+
+	stats._tables.Update([&](Table& table) {
+		auto [it, inserted] = table.sites.try_emplace(site);
+		if (inserted) {
+			it->second.name = kind == CallKind::Export ? method.GetFunctionName() : method.GetName();
+		}
+		++it->second.calls;
+	});
+}
+
+AllocStats::Scope::~Scope() {
+	if (_active) {
+		g_currentSite = _previous;
+	}
+}
+
+void AllocStats::Record(AllocKind kind, plugify::ValueType type, size_t bytes) {
+	if (!IsEnabled())
+		return;
+
+	_tables.Update([&](Table& table) {
+		Counter& counter = table.allocs[Key{ g_currentSite, type, kind }];
+		++counter.count;
+		counter.bytes += bytes;
+	});
+}
+
+void AllocStats::MergeInto(Table& dest, const Table& source) {
+	for (const auto& [key, counter] : source.allocs) {
+		Counter& merged = dest.allocs[key];
+		merged.count += counter.count;
+		merged.bytes += counter.bytes;
+	}
+	for (const auto& [site, entry] : source.sites) {
+		auto [it, inserted] = dest.sites.try_emplace(site);
+		if (inserted) {
+			it->second.name = entry.name;
+		}
+		it->second.calls += entry.calls;
+	}
+}
+
+std::string AllocStats::Report() {
+	Table merged;
+	std::unique_lock lock(_retiredMutex);
+	_tables.Collect([&merged](const Table& table) {
+		MergeInto(merged, table);
+	}, [this](Table& table) {
+		MergeInto(_retired, table);
+	});
+	MergeInto(merged, _retired);
+	lock.unlock();
+
+	struct Row {
+		std::string name;
+		Counter managed;
+		Counter native;
+		uint64_t calls{};
+
+		uint64_t Bytes() const { return managed.bytes + native.bytes; }
+	};
+
+	std::unordered_map<plugify::ValueType, Row> byType;
+	std::unordered_map<const void*, Row> bySite;
+	for (const auto& [key, counter] : merged.allocs) {
+		for (Row* row : { &byType[key.type], &bySite[key.site] }) {
+			Counter& dest = key.kind == AllocKind::Managed ? row->managed : row->native;
+			dest.count += counter.count;
+			dest.bytes += counter.bytes;
+		}
+	}
+
+	auto sorted = [](auto& rows) {
+		std::vector<Row*> result;
+		result.reserve(rows.size());
+		for (auto& [_, row] : rows) {
+			result.push_back(&row);
+		}
+		std::sort(result.begin(), result.end(), [](const Row* a, const Row* b) {
+			return a->Bytes() > b->Bytes();
+		});
+		return result;
+	};
+
+	for (auto& [type, row] : byType) {
+		row.name = plugify::ValueUtils::ToString(type);
+	}
+	for (auto& [site, row] : bySite) {
+		auto it = merged.sites.find(site);
+		if (it != merged.sites.end()) {
+			row.name = it->second.name;
+			row.calls = it->second.calls;
+		} else {
+			row.name = "<outside bridge calls>";
+		}
+	}
+
+	std::string report = std::format("{:>12} {:>14} {:>12} {:>14}  {}\n",
+									 "managed", "managed bytes", "native", "native bytes", "type");
+	for (const Row* row : sorted(byType)) {
+		std::format_to(std::back_inserter(report), "{:>12} {:>14} {:>12} {:>14}  {}\n",
+					   row->managed.count, row->managed.bytes, row->native.count, row->native.bytes, row->name);
+	}
+
+	std::format_to(std::back_inserter(report), "\n{:>12} {:>12} {:>14} {:>12} {:>14} {:>12}  {}\n",
+				   "calls", "managed", "managed bytes", "native", "native bytes", "bytes/call", "method");
+	for (const Row* row : sorted(bySite)) {
+		double perCall = row->calls ? static_cast<double>(row->Bytes()) / static_cast<double>(row->calls) : 0.0;
+		std::format_to(std::back_inserter(report), "{:>12} {:>12} {:>14} {:>12} {:>14} {:>12.1f}  {}\n",
+					   row->calls, row->managed.count, row->managed.bytes, row->native.count, row->native.bytes, perCall, row->name);
+	}
+	return report;
+}
+
+void AllocStats::Reset() {
+	_tables.ForEach([](Table& table) {
+		table.allocs.clear();
+		table.sites.clear();
+	});
+	std::lock_guard lock(_retiredMutex);
+	_retired.allocs.clear();
+	_retired.sites.clear();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "call_stats.h"
+#include "per_thread.h"
+
+#include <plugify/method.h>
+#include <plugify/value_type.h>
+
+namespace monolm {
+	enum class AllocKind : uint8_t {
+		Managed, // strings, arrays, delegates and boxed return values created on the managed heap
+		Native,  // argument copies on the native heap
+	};
+
+	/// Counts allocations made while marshalling arguments and return values, by bridge call and value type.
+	class AllocStats {
+	public:
+		AllocStats() = default;
+		~AllocStats() = default;
+
+		void Enable(bool enable) { _enabled.store(enable, std::memory_order_relaxed); }
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		/// Attributes allocations of the calling thread to one bridge call until destroyed, scopes nest for re-entrant calls.
+		class Scope {
+		public:
+			Scope(AllocStats& stats, const void* site, CallKind kind, plugify::MethodRef method);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			bool _active;
+			const void* _previous{ nullptr };
+		};
+
+		void Record(AllocKind kind, plugify::ValueType type, size_t bytes);
+
+		/// Text tables of allocations by value type and by method, sorted by bytes.
+		std::string Report();
+		void Reset();
+
+	private:
+		struct Key {
+			const void* site;
+			plugify::ValueType type;
+			AllocKind kind;
+
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const noexcept {
+				size_t hash = std::hash<const void*>{}(key.site);
+				return hash ^ (static_cast<size_t>(key.type) << 1 | static_cast<size_t>(key.kind)) * 0x9E3779B97F4A7C15ull;
+			}
+		};
+
+		struct Counter {
+			uint64_t count{};
+			uint64_t bytes{};
+		};
+
+		struct Site {
+			std::string name;
+			uint64_t calls{};
+		};
+
+		struct Table {
+			std::unordered_map<Key, Counter, KeyHash> allocs;
+			std::unordered_map<const void*, Site> sites;
+		};
+
+		static void MergeInto(Table& dest, const Table& source);
+
+		std::atomic<bool> _enabled{ false };
+		PerThread<Table> _tables;
+		Table _retired;
+		std::mutex _retiredMutex;
+	};
+}
@@ -0,0 +1,150 @@
+#include "call_recorder.h"
+#include "call_trace.h"
+
+using namespace monolm;
+using namespace plugify;
+
+namespace {
+	// Offset of the start and duration fields in a call record: tag, id, thread
+	constexpr size_t kTimeOffset = sizeof(trace::Tag) + sizeof(uint32_t) + sizeof(uint32_t);
+
+	thread_local uint32_t t_thread = UINT32_MAX;
+}
+
+CallRecorder::~CallRecorder() {
+	Close();
+}
+
+bool CallRecorder::Open(const fs::path& path) {
+	std::lock_guard lock(_mutex);
+	if (_file)
+		return true;
+
+	std::error_code ec;
+	if (path.has_parent_path()) {
+		fs::create_directories(path.parent_path(), ec);
+	}
+
+	_file = std::fopen(path.string().c_str(), "wb");
+	if (!_file)
+		return false;
+	_path = path;
+	_start = std::chrono::steady_clock::now();
+
+	trace::FileHeader header{};
+	std::memcpy(header.magic, trace::kMagic, sizeof(header.magic));
+	header.version = trace::kVersion;
+	header.startUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	if (std::fwrite(&header, sizeof(header), 1, _file) != 1) {
+		std::fclose(_file);
+		_file = nullptr;
+		return false;
+	}
+
+	_open.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void CallRecorder::Close() {
+	std::lock_guard lock(_mutex);
+	_open.store(false, std::memory_order_relaxed);
+	if (_file) {
+		std::fclose(_file);
+		_file = nullptr;
+	}
+}
+
+uint32_t CallRecorder::AddMethod(std::string_view plugin, MethodRef method) {
+	if (!IsOpen())
+		return 0;
+
+	uint32_t id = _nextMethod.fetch_add(1, std::memory_order_relaxed);
+	std::span<const PropertyRef> paramProps = method.GetParamTypes();
+
+	std::string record;
+	trace::Encode(record, trace::Tag::Method);
+	trace::Encode(record, id);
+	trace::Encode(record, static_cast<uint8_t>(method.GetReturnType().GetType()));
+	trace::Encode(record, static_cast<uint8_t>(paramProps.size()));
+	for (const auto& param : paramProps) {
+		trace::Encode(record, static_cast<uint8_t>(static_cast<uint8_t>(param.GetType()) | (param.IsReference() ? trace::kRefFlag : 0)));
+	}
+	trace::EncodeName(record, plugin);
+	trace::EncodeName(record, method.GetName());
+	Write(record);
+	return id;
+}
+
+void CallRecorder::AddTick(float deltaTime) {
+	if (!IsOpen())
+		return;
+
+	std::string record;
+	trace::Encode(record, trace::Tag::Tick);
+	trace::Encode(record, GetTimestamp(std::chrono::steady_clock::now()));
+	trace::Encode(record, deltaTime);
+	Write(record);
+}
+
+uint64_t CallRecorder::GetTimestamp(std::chrono::steady_clock::time_point time) const {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - _start).count());
+}
+
+void CallRecorder::Write(const std::string& record) {
+	std::lock_guard lock(_mutex);
+	if (!_file)
+		return;
+
+	// A full disk ends the capture instead of leaving a torn record behind
+	if (std::fwrite(record.data(), 1, record.size(), _file) != record.size()) {
+		std::fclose(_file);
+		_file = nullptr;
+		_open.store(false, std::memory_order_relaxed);
+	}
+}
+
+CallRecorder::Scope::Scope(CallRecorder& recorder, uint32_t id, MethodRef method, const JitCallback::Parameters* p, uint8_t count) {
+	if (id == 0 || !recorder.IsOpen())
+		return;
+
+	_recorder = &recorder;
+
+	if (t_thread == UINT32_MAX) {
+		t_thread = recorder._nextThread.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	trace::Encode(_record, trace::Tag::Call);
+	trace::Encode(_record, id);
+	trace::Encode(_record, t_thread);
+	trace::Encode(_record, uint64_t{}); // start
+	trace::Encode(_record, uint64_t{}); // duration
+
+	std::span<const PropertyRef> paramProps = method.GetParamTypes();
+	bool hasRet = ValueUtils::IsHiddenParam(method.GetReturnType().GetType());
+	for (uint8_t i = hasRet, j = 0; i < count; ++i, ++j) {
+		const auto& param = paramProps[j];
+		trace::Visit(param.GetType(), [&]<typename T>(std::type_identity<T>) {
+			if constexpr (trace::kPassedByPointer<T>) {
+				trace::Encode(_record, *p->GetArgument<T*>(i));
+			} else if (param.IsReference()) {
+				trace::Encode(_record, *p->GetArgument<T*>(i));
+			} else {
+				trace::Encode(_record, p->GetArgument<T>(i));
+			}
+		});
+	}
+
+	_start = std::chrono::steady_clock::now();
+}
+
+CallRecorder::Scope::~Scope() {
+	if (!_recorder)
+		return;
+
+	auto end = std::chrono::steady_clock::now();
+	uint64_t times[2] = { _recorder->GetTimestamp(_start), static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count()) };
+	std::memcpy(_record.data() + kTimeOffset, times, sizeof(times));
+
+	_recorder->Write(_record);
+	_recorder->_calls.fetch_add(1, std::memory_order_relaxed);
+}
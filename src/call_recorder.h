@@ -0,0 +1,54 @@
+#pragma once
+
+#include <plugify/jit/callback.h>
+#include <plugify/method.h>
+
+#include <cstdio>
+
+namespace monolm {
+	/// Captures calls of exported methods with their arguments and the module ticks into a binary trace (see call_trace.h),
+	/// which the replay tool feeds back through the headless host.
+	class CallRecorder {
+	public:
+		CallRecorder() = default;
+		~CallRecorder();
+
+		bool Open(const fs::path& path);
+		void Close();
+		bool IsOpen() const { return _open.load(std::memory_order_relaxed); }
+		const fs::path& GetPath() const { return _path; }
+		uint64_t GetCallCount() const { return _calls.load(std::memory_order_relaxed); }
+
+		/// Writes the signature of an exported method, returns its id for Scope or 0 if the trace is closed.
+		uint32_t AddMethod(std::string_view plugin, plugify::MethodRef method);
+		void AddTick(float deltaTime);
+
+		/// Serializes the arguments on entry, so references hold their input values, and writes the call on exit.
+		class Scope {
+		public:
+			Scope(CallRecorder& recorder, uint32_t id, plugify::MethodRef method, const plugify::JitCallback::Parameters* p, uint8_t count);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			CallRecorder* _recorder{ nullptr };
+			std::chrono::steady_clock::time_point _start;
+			std::string _record;
+		};
+
+	private:
+		uint64_t GetTimestamp(std::chrono::steady_clock::time_point time) const;
+		void Write(const std::string& record);
+
+		std::FILE* _file{ nullptr };
+		fs::path _path;
+		std::mutex _mutex;
+		std::atomic<bool> _open{ false };
+		std::chrono::steady_clock::time_point _start;
+		std::atomic<uint32_t> _nextMethod{ 1 };
+		std::atomic<uint32_t> _nextThread{ 0 };
+		std::atomic<uint64_t> _calls{ 0 };
+	};
+}
@@ -0,0 +1,141 @@
+#include "call_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace monolm;
+
+size_t LatencyHistogram::BucketOf(uint64_t ns) {
+	if (ns < kLinear)
+		return static_cast<size_t>(ns);
+
+	auto exponent = static_cast<size_t>(std::bit_width(ns) - 1);
+	if (exponent >= kMaxExponent)
+		return kBuckets - 1;
+
+	auto sub = static_cast<size_t>((ns >> (exponent - 3)) & (kSubBuckets - 1));
+	return kLinear + (exponent - 4) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::UpperBoundOf(size_t bucket) {
+	if (bucket < kLinear)
+		return bucket;
+
+	size_t exponent = (bucket - kLinear) / kSubBuckets + 4;
+	size_t sub = (bucket - kLinear) % kSubBuckets;
+	return ((kSubBuckets + sub + 1) << (exponent - 3)) - 1;
+}
+
+void LatencyHistogram::Add(uint64_t ns) {
+	++counts[BucketOf(ns)];
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+	for (size_t i = 0; i < kBuckets; ++i) {
+		counts[i] += other.counts[i];
+	}
+}
+
+uint64_t LatencyHistogram::Quantile(double q) const {
+	uint64_t total = 0;
+	for (uint32_t count : counts) {
+		total += count;
+	}
+	if (total == 0)
+		return 0;
+
+	auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < kBuckets; ++i) {
+		seen += counts[i];
+		if (seen >= rank && counts[i] != 0)
+			return UpperBoundOf(i);
+	}
+	return UpperBoundOf(kBuckets - 1);
+}
+
+void CallCounters::Merge(const CallCounters& other) {
+	calls += other.calls;
+	exceptions += other.exceptions;
+	totalNs += other.totalNs;
+	calleeNs += other.calleeNs;
+	maxNs = std::max(maxNs, other.maxNs);
+	histogram.Merge(other.histogram);
+}
+
+void CallStats::Record(const void* site, CallKind kind, plugify::MethodRef method, uint64_t totalNs, uint64_t calleeNs, bool exception) {
+	_tables.Update([&](Table& table) {
+		auto [it, inserted] = table.try_emplace(site);
+		Entry& entry = it->second;
+		if (inserted) {
+			entry.name = kind == CallKind::Export ? method.GetFunctionName() : method.GetName();
+			entry.kind = kind;
+		}
+
+		CallCounters& counters = entry.counters;
+		++counters.calls;
+		counters.exceptions += exception;
+		counters.totalNs += totalNs;
+		counters.calleeNs += calleeNs;
+		counters.maxNs = std::max(counters.maxNs, totalNs);
+		counters.histogram.Add(totalNs);
+	});
+}
+
+void CallStats::MergeInto(Table& dest, const Table& source) {
+	for (const auto& [site, entry] : source) {
+		auto [it, inserted] = dest.try_emplace(site);
+		if (inserted) {
+			it->second.name = entry.name;
+			it->second.kind = entry.kind;
+		}
+		it->second.counters.Merge(entry.counters);
+	}
+}
+
+std::string CallStats::Report() {
+	Table merged;
+	std::unique_lock lock(_retiredMutex);
+	_tables.Collect([&merged](const Table& table) {
+		MergeInto(merged, table);
+	}, [this](Table& table) {
+		MergeInto(_retired, table);
+	});
+	MergeInto(merged, _retired);
+	lock.unlock();
+
+	std::vector<const Entry*> entries;
+	entries.reserve(merged.size());
+	for (const auto& [_, entry] : merged) {
+		entries.push_back(&entry);
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+		return a->counters.totalNs > b->counters.totalNs;
+	});
+
+	constexpr std::string_view kKindNames[] = { "export", "import", "delegate" };
+
+	std::string report = std::format("{:<8} {:>12} {:>8} {:>12} {:>10} {:>10} {:>10} {:>10} {:>8}  {}\n",
+									 "kind", "calls", "except", "total ms", "mean us", "p50 us", "p99 us", "max us", "callee%", "method");
+	for (const Entry* entry : entries) {
+		const CallCounters& c = entry->counters;
+		double mean = c.calls ? static_cast<double>(c.totalNs) / static_cast<double>(c.calls) / 1000.0 : 0.0;
+		double callee = c.totalNs ? static_cast<double>(c.calleeNs) * 100.0 / static_cast<double>(c.totalNs) : 0.0;
+		std::format_to(std::back_inserter(report), "{:<8} {:>12} {:>8} {:>12.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>8.1f}  {}\n",
+					   kKindNames[static_cast<size_t>(entry->kind)], c.calls, c.exceptions,
+					   static_cast<double>(c.totalNs) / 1e6, mean,
+					   static_cast<double>(c.histogram.Quantile(0.5)) / 1000.0,
+					   static_cast<double>(c.histogram.Quantile(0.99)) / 1000.0,
+					   static_cast<double>(c.maxNs) / 1000.0, callee, entry->name);
+	}
+	return report;
+}
+
+void CallStats::Reset() {
+	_tables.ForEach([](Table& table) {
+		table.clear();
+	});
+	std::lock_guard lock(_retiredMutex);
+	_retired.clear();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <plugify/method.h>
+
+namespace monolm {
+	enum class CallKind : uint8_t {
+		Export,   // native -> C# exported method
+		Import,   // C# -> native method of another plugin
+		Delegate, // native -> C# delegate
+	};
+
+	/// Log-linear latency histogram in nanoseconds, 8 sub-buckets per power of two (~12% precision).
+	struct LatencyHistogram {
+		static constexpr size_t kLinear = 16;
+		static constexpr size_t kSubBuckets = 8;
+		static constexpr size_t kMaxExponent = 40; // ~18 minutes
+		static constexpr size_t kBuckets = kLinear + (kMaxExponent - 4) * kSubBuckets;
+
+		std::array<uint32_t, kBuckets> counts{};
+
+		void Add(uint64_t ns);
+		void Merge(const LatencyHistogram& other);
+		/// Upper bound of the bucket holding the given quantile, 0 if the histogram is empty.
+		uint64_t Quantile(double q) const;
+
+		static size_t BucketOf(uint64_t ns);
+		static uint64_t UpperBoundOf(size_t bucket);
+	};
+
+	struct CallCounters {
+		uint64_t calls{};
+		uint64_t exceptions{};
+		uint64_t totalNs{};
+		uint64_t calleeNs{};
+		uint64_t maxNs{};
+		LatencyHistogram histogram;
+
+		void Merge(const CallCounters& other);
+	};
+
+	/// Per-method call counters of the interop bridge. Threads record into their own table, which is only
+	/// contended while a report is being aggregated.
+	class CallStats {
+	public:
+		CallStats() = default;
+		~CallStats() = default;
+
+		void Enable(bool enable) { _enabled.store(enable, std::memory_order_relaxed); }
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		/// Site identifies the call target (export, import or delegate slot), the method is only read on the first call.
+		void Record(const void* site, CallKind kind, plugify::MethodRef method, uint64_t totalNs, uint64_t calleeNs, bool exception);
+
+		/// Text table of all methods with calls, sorted by total time.
+		std::string Report();
+		void Reset();
+
+	private:
+		struct Entry {
+			std::string name;
+			CallKind kind{};
+			CallCounters counters;
+		};
+
+		using Table = std::unordered_map<const void*, Entry>;
+
+		static void MergeInto(Table& dest, const Table& source);
+
+		std::atomic<bool> _enabled{ false };
+		PerThread<Table> _tables;
+		Table _retired;
+		std::mutex _retiredMutex;
+	};
+
+	/// Measures one bridge call, records on destruction when statistics are enabled.
+	class CallTimer {
+	public:
+		CallTimer(CallStats& stats, const void* site, CallKind kind, plugify::MethodRef method)
+			: _stats{stats.IsEnabled() ? &stats : nullptr}, _site{site}, _method{method}, _kind{kind} {
+			if (_stats) {
+				_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~CallTimer() {
+			if (_stats) {
+				auto end = std::chrono::steady_clock::now();
+				_stats->Record(_site, _kind, _method, ToNs(end - _start), ToNs(_calleeEnd - _calleeStart), _exception);
+			}
+		}
+
+		CallTimer(const CallTimer&) = delete;
+		CallTimer& operator=(const CallTimer&) = delete;
+
+		void BeginCallee() {
+			if (_stats) {
+				_calleeStart = std::chrono::steady_clock::now();
+			}
+		}
+
+		void EndCallee() {
+			if (_stats) {
+				_calleeEnd = std::chrono::steady_clock::now();
+			}
+		}
+
+		void SetException() { _exception = true; }
+
+	private:
+		static uint64_t ToNs(std::chrono::steady_clock::duration duration) {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+		}
+
+		CallStats* _stats;
+		const void* _site;
+		plugify::MethodRef _method;
+		CallKind _kind;
+		bool _exception{ false };
+		std::chrono::steady_clock::time_point _start;
+		std::chrono::steady_clock::time_point _calleeStart;
+		std::chrono::steady_clock::time_point _calleeEnd;
+	};
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <plugify/math.h>
+#include <plugify/string.h>
+#include <plugify/value_type.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// Binary format of captured cross-language calls, written by CallRecorder and read by the replay tool
+/// (test/replay). Values are stored in the byte order of the capturing machine, sizes and counts as uint32.
+///
+/// File:   FileHeader, then records, each starting with a Tag byte
+/// Method: uint32 id, uint8 return type, uint8 count, count x uint8 parameter type (| kRefFlag), string plugin, string name
+/// Call:   uint32 id, uint32 thread, uint64 start ns, uint64 duration ns, argument values in parameter order
+/// Tick:   uint64 start ns, float delta time
+///
+/// Calls are written when they return, so nested calls precede their caller; start times give the call order.
+namespace monolm::trace {
+	constexpr char kMagic[4] = { 'M', 'L', 'C', 'T' };
+	constexpr uint32_t kVersion = 1;
+	constexpr uint8_t kRefFlag = 0x80;
+
+	struct FileHeader {
+		char magic[4];
+		uint32_t version;
+		int64_t startUnixNs; // wall clock at the start of the capture, for reference only
+	};
+
+	enum class Tag : uint8_t {
+		Method = 1,
+		Call = 2,
+		Tick = 3,
+	};
+
+	template<typename T>
+	struct IsVector : std::false_type {};
+	template<typename T>
+	struct IsVector<std::vector<T>> : std::true_type {};
+
+	/// Plugify passes everything except arithmetic values by pointer, also when it is not a reference.
+	template<typename T>
+	constexpr bool kPassedByPointer = !std::is_arithmetic_v<T>;
+
+	/// Calls visitor with std::type_identity of the C++ type holding a value of the given type. Returns false for types
+	/// without a recorded payload: pointers and functions are only meaningful in the capturing process.
+	template<typename F>
+	bool Visit(plugify::ValueType type, F&& visitor) {
+		using plugify::ValueType;
+		switch (type) {
+			case ValueType::Bool: visitor(std::type_identity<bool>{}); return true;
+			case ValueType::Char8: visitor(std::type_identity<char>{}); return true;
+			case ValueType::Char16: visitor(std::type_identity<char16_t>{}); return true;
+			case ValueType::Int8: visitor(std::type_identity<int8_t>{}); return true;
+			case ValueType::Int16: visitor(std::type_identity<int16_t>{}); return true;
+			case ValueType::Int32: visitor(std::type_identity<int32_t>{}); return true;
+			case ValueType::Int64: visitor(std::type_identity<int64_t>{}); return true;
+			case ValueType::UInt8: visitor(std::type_identity<uint8_t>{}); return true;
+			case ValueType::UInt16: visitor(std::type_identity<uint16_t>{}); return true;
+			case ValueType::UInt32: visitor(std::type_identity<uint32_t>{}); return true;
+			case ValueType::UInt64: visitor(std::type_identity<uint64_t>{}); return true;
+			case ValueType::Float: visitor(std::type_identity<float>{}); return true;
+			case ValueType::Double: visitor(std::type_identity<double>{}); return true;
+			case ValueType::Vector2: visitor(std::type_identity<plugify::Vector2>{}); return true;
+			case ValueType::Vector3: visitor(std::type_identity<plugify::Vector3>{}); return true;
+			case ValueType::Vector4: visitor(std::type_identity<plugify::Vector4>{}); return true;
+			case ValueType::Matrix4x4: visitor(std::type_identity<plugify::Matrix4x4>{}); return true;
+			case ValueType::String: visitor(std::type_identity<plg::string>{}); return true;
+			case ValueType::ArrayBool: visitor(std::type_identity<std::vector<bool>>{}); return true;
+			case ValueType::ArrayChar8: visitor(std::type_identity<std::vector<char>>{}); return true;
+			case ValueType::ArrayChar16: visitor(std::type_identity<std::vector<char16_t>>{}); return true;
+			case ValueType::ArrayInt8: visitor(std::type_identity<std::vector<int8_t>>{}); return true;
+			case ValueType::ArrayInt16: visitor(std::type_identity<std::vector<int16_t>>{}); return true;
+			case ValueType::ArrayInt32: visitor(std::type_identity<std::vector<int32_t>>{}); return true;
+			case ValueType::ArrayInt64: visitor(std::type_identity<std::vector<int64_t>>{}); return true;
+			case ValueType::ArrayUInt8: visitor(std::type_identity<std::vector<uint8_t>>{}); return true;
+			case ValueType::ArrayUInt16: visitor(std::type_identity<std::vector<uint16_t>>{}); return true;
+			case ValueType::ArrayUInt32: visitor(std::type_identity<std::vector<uint32_t>>{}); return true;
+			case ValueType::ArrayUInt64: visitor(std::type_identity<std::vector<uint64_t>>{}); return true;
+			case ValueType::ArrayPointer: visitor(std::type_identity<std::vector<uintptr_t>>{}); return true;
+			case ValueType::ArrayFloat: visitor(std::type_identity<std::vector<float>>{}); return true;
+			case ValueType::ArrayDouble: visitor(std::type_identity<std::vector<double>>{}); return true;
+			case ValueType::ArrayString: visitor(std::type_identity<std::vector<plg::string>>{}); return true;
+			default: return false;
+		}
+	}
+
+	template<typename T>
+	void Encode(std::string& out, const T& value) {
+		if constexpr (std::is_same_v<T, plg::string>) {
+			Encode(out, static_cast<uint32_t>(value.size()));
+			out.append(value.data(), value.size());
+		} else if constexpr (std::is_same_v<T, std::vector<bool>>) {
+			Encode(out, static_cast<uint32_t>(value.size()));
+			for (bool element : value) {
+				out.push_back(static_cast<char>(element));
+			}
+		} else if constexpr (IsVector<T>::value) {
+			Encode(out, static_cast<uint32_t>(value.size()));
+			if constexpr (std::is_trivially_copyable_v<typename T::value_type>) {
+				out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(typename T::value_type));
+			} else {
+				for (const auto& element : value) {
+					Encode(out, element);
+				}
+			}
+		} else {
+			static_assert(std::is_trivially_copyable_v<T>);
+			out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+	}
+
+	inline void EncodeName(std::string& out, std::string_view name) {
+		auto size = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+		Encode(out, size);
+		out.append(name.data(), size);
+	}
+
+	/// Bounds checked reader over a loaded trace, every Read fails once the data is exhausted.
+	class Reader {
+	public:
+		Reader(const char* data, size_t size) : _data{data}, _end{data + size} {}
+
+		const char* GetPosition() const { return _data; }
+		size_t Remaining() const { return static_cast<size_t>(_end - _data); }
+
+		template<typename T>
+		bool Read(T& value) {
+			if constexpr (std::is_same_v<T, plg::string>) {
+				uint32_t size;
+				if (!Read(size) || Remaining() < size)
+					return false;
+				value.assign(_data, size);
+				_data += size;
+				return true;
+			} else if constexpr (std::is_same_v<T, std::vector<bool>>) {
+				uint32_t size;
+				if (!Read(size) || Remaining() < size)
+					return false;
+				value.resize(size);
+				for (uint32_t i = 0; i < size; ++i) {
+					value[i] = _data[i] != 0;
+				}
+				_data += size;
+				return true;
+			} else if constexpr (IsVector<T>::value) {
+				uint32_t size;
+				if (!Read(size))
+					return false;
+				using Element = typename T::value_type;
+				if constexpr (std::is_trivially_copyable_v<Element>) {
+					if (Remaining() / sizeof(Element) < size)
+						return false;
+					value.resize(size);
+					std::memcpy(value.data(), _data, size * sizeof(Element));
+					_data += size * sizeof(Element);
+				} else {
+					value.resize(size);
+					for (auto& element : value) {
+						if (!Read(element))
+							return false;
+					}
+				}
+				return true;
+			} else {
+				static_assert(std::is_trivially_copyable_v<T>);
+				if (Remaining() < sizeof(T))
+					return false;
+				std::memcpy(&value, _data, sizeof(T));
+				_data += sizeof(T);
+				return true;
+			}
+		}
+
+		bool ReadName(std::string& value) {
+			uint16_t size;
+			if (!Read(size) || Remaining() < size)
+				return false;
+			value.assign(_data, size);
+			_data += size;
+			return true;
+		}
+
+	private:
+		const char* _data;
+		const char* _end;
+	};
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+namespace monolm {
+	/// Hash map split into independently locked shards, lookups only take a shared lock of one shard.
+	template<typename K, typename V, typename Hash = std::hash<K>, size_t ShardCount = 16>
+	class ConcurrentMap {
+		static_assert(ShardCount != 0 && (ShardCount & (ShardCount - 1)) == 0, "Shard count must be a power of two");
+
+	public:
+		ConcurrentMap() = default;
+		~ConcurrentMap() = default;
+
+		ConcurrentMap(const ConcurrentMap&) = delete;
+		ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+		/// Calls fn with the value under a shared lock, returns false if the key is missing.
+		template<typename F>
+		bool Find(const K& key, F&& fn) const {
+			const Shard& shard = GetShard(key);
+			std::shared_lock lock(shard.mutex);
+			auto it = shard.map.find(key);
+			if (it == shard.map.end())
+				return false;
+			fn(std::as_const(it->second));
+			return true;
+		}
+
+		/// Calls fn with the mutable value under an exclusive lock, returns false if the key is missing.
+		template<typename F>
+		bool Update(const K& key, F&& fn) {
+			Shard& shard = GetShard(key);
+			std::unique_lock lock(shard.mutex);
+			auto it = shard.map.find(key);
+			if (it == shard.map.end())
+				return false;
+			fn(it->second);
+			return true;
+		}
+
+		/// Calls fn with the mutable value under an exclusive lock, default constructing it if the key is missing.
+		template<typename F>
+		void Upsert(const K& key, F&& fn) {
+			Shard& shard = GetShard(key);
+			std::unique_lock lock(shard.mutex);
+			fn(shard.map[key]);
+		}
+
+		/// Calls fn with the mutable value under an exclusive lock and removes the entry if fn returns true.
+		template<typename F>
+		bool UpdateOrErase(const K& key, F&& fn) {
+			Shard& shard = GetShard(key);
+			std::unique_lock lock(shard.mutex);
+			auto it = shard.map.find(key);
+			if (it == shard.map.end())
+				return false;
+			if (fn(it->second)) {
+				shard.map.erase(it);
+			}
+			return true;
+		}
+
+		template<typename... Args>
+		bool Emplace(const K& key, Args&&... args) {
+			Shard& shard = GetShard(key);
+			std::unique_lock lock(shard.mutex);
+			return shard.map.try_emplace(key, std::forward<Args>(args)...).second;
+		}
+
+		template<typename T>
+		void InsertOrAssign(const K& key, T&& value) {
+			Shard& shard = GetShard(key);
+			std::unique_lock lock(shard.mutex);
+			shard.map.insert_or_assign(key, std::forward<T>(value));
+		}
+
+		/// Removes every entry for which pred(key, value) returns true, one shard at a time.
+		template<typename P>
+		size_t EraseIf(P&& pred) {
+			size_t count = 0;
+			for (Shard& shard : _shards) {
+				std::unique_lock lock(shard.mutex);
+				count += std::erase_if(shard.map, [&pred](const auto& entry) { return pred(entry.first, entry.second); });
+			}
+			return count;
+		}
+
+		void Clear() {
+			for (Shard& shard : _shards) {
+				std::unique_lock lock(shard.mutex);
+				shard.map.clear();
+			}
+		}
+
+		size_t Size() const {
+			size_t size = 0;
+			for (const Shard& shard : _shards) {
+				std::shared_lock lock(shard.mutex);
+				size += shard.map.size();
+			}
+			return size;
+		}
+
+	private:
+		struct alignas(64) Shard {
+			mutable std::shared_mutex mutex;
+			std::unordered_map<K, V, Hash> map;
+		};
+
+		static size_t GetShardIndex(const K& key) {
+			// Fibonacci hashing, pointer keys have their low bits zero
+			auto hash = static_cast<uint64_t>(Hash{}(key));
+			return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> 32) & (ShardCount - 1);
+		}
+
+		Shard& GetShard(const K& key) { return _shards[GetShardIndex(key)]; }
+		const Shard& GetShard(const K& key) const { return _shards[GetShardIndex(key)]; }
+
+		std::array<Shard, ShardCount> _shards;
+	};
+}
@@ -0,0 +1,169 @@
+#include "gc_monitor.h"
+
+#include <mono/metadata/mono-gc.h>
+#include <mono/metadata/profiler.h>
+
+using namespace monolm;
+
+namespace {
+	uint64_t ToNs(TraceClock::duration duration) {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	}
+
+	// Finished event of the collecting thread, copied while it still holds the GC lock and published once it is released
+	thread_local std::optional<GcEvent> t_finished;
+}
+
+struct monolm::GcProfilerCallbacks {
+	static void OnGcEvent(MonoProfiler* profiler, MonoProfilerGCEvent event, uint32_t generation, mono_bool /*isSerial*/) {
+		reinterpret_cast<GcMonitor*>(profiler)->HandleEvent(event, generation);
+	}
+};
+
+void GcMonitor::Enable() {
+	if (_enabled)
+		return;
+
+	{
+		std::lock_guard lock(_mutex);
+		_origin = TraceClock::now();
+		_events.reserve(kCapacity);
+	}
+
+	// Profiler handles live until the runtime shuts down
+	MonoProfilerHandle handle = mono_profiler_create(reinterpret_cast<MonoProfiler*>(this));
+	mono_profiler_set_gc_event_callback(handle, &GcProfilerCallbacks::OnGcEvent);
+	_enabled = true;
+}
+
+void GcMonitor::HandleEvent(int event, uint32_t generation) {
+	if (!_enabled.load(std::memory_order_relaxed))
+		return;
+
+	// Other threads are suspended between the locked and unlocked events, no locks may be taken there
+	switch (event) {
+		case MONO_GC_EVENT_PRE_STOP_WORLD_LOCKED:
+			_current = GcEvent{};
+			_current.start = TraceClock::now();
+			_current.heapBefore = mono_gc_get_heap_size();
+			_collecting = false;
+			break;
+		case MONO_GC_EVENT_START:
+			_current.generation = static_cast<int32_t>(generation);
+			_collectStart = TraceClock::now();
+			_collecting = true;
+			break;
+		case MONO_GC_EVENT_END:
+			if (_collecting) {
+				_current.collectNs += ToNs(TraceClock::now() - _collectStart);
+			}
+			break;
+		case MONO_GC_EVENT_POST_START_WORLD:
+			// The world is also stopped for other reasons than collections, e.g. by the debugger
+			if (!_collecting)
+				break;
+			_collecting = false;
+			_current.pauseNs = ToNs(TraceClock::now() - _current.start);
+			_current.heapAfter = mono_gc_get_heap_size();
+			// Another collection may overwrite _current as soon as the GC lock is released
+			t_finished = _current;
+			break;
+		case MONO_GC_EVENT_POST_START_WORLD_UNLOCKED: {
+			if (!t_finished)
+				break;
+			GcEvent finished = *t_finished;
+			t_finished.reset();
+
+			std::lock_guard lock(_mutex);
+			if (_events.size() < kCapacity) {
+				_events.push_back(finished);
+			} else {
+				_events[_next] = finished;
+			}
+			_next = (_next + 1) % kCapacity;
+
+			_pauses.Add(finished.pauseNs);
+			++_totals.collections;
+			++(finished.generation == 0 ? _totals.minorCollections : _totals.majorCollections);
+			_totals.pauseTotalNs += static_cast<int64_t>(finished.pauseNs);
+			_totals.pauseMaxNs = std::max(_totals.pauseMaxNs, static_cast<int64_t>(finished.pauseNs));
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+GcSummary GcMonitor::GetSummary() {
+	auto now = TraceClock::now();
+
+	std::lock_guard lock(_mutex);
+	GcSummary summary = _totals;
+	summary.pauseP50Ns = static_cast<int64_t>(_pauses.Quantile(0.5));
+	summary.pauseP99Ns = static_cast<int64_t>(_pauses.Quantile(0.99));
+
+	size_t lastMinute = 0;
+	for (const GcEvent& event : _events) {
+		lastMinute += now - event.start <= std::chrono::minutes(1);
+	}
+	// Scaled up while the monitor has run for less than a minute
+	double minutes = std::min(std::chrono::duration<double, std::ratio<60>>(now - _origin).count(), 1.0);
+	summary.collectionsPerMinute = minutes > 0.0 ? static_cast<double>(lastMinute) / minutes : 0.0;
+	summary.heapSize = IsEnabled() ? mono_gc_get_heap_size() : 0;
+	return summary;
+}
+
+std::vector<GcEvent> GcMonitor::GetEvents() {
+	std::lock_guard lock(_mutex);
+	std::vector<GcEvent> events;
+	events.reserve(_events.size());
+	if (_events.size() == kCapacity) {
+		events.insert(events.end(), _events.begin() + static_cast<ptrdiff_t>(_next), _events.end());
+		events.insert(events.end(), _events.begin(), _events.begin() + static_cast<ptrdiff_t>(_next));
+	} else {
+		events = _events;
+	}
+	return events;
+}
+
+std::vector<TraceEvent> GcMonitor::GetTraceEvents() {
+	std::vector<GcEvent> events = GetEvents();
+
+	std::vector<TraceEvent> traceEvents;
+	traceEvents.reserve(events.size());
+	for (const GcEvent& event : events) {
+		TraceEvent& traceEvent = traceEvents.emplace_back();
+		traceEvent.name = event.generation == 0 ? "GC minor" : "GC major";
+		traceEvent.cat = "gc";
+		traceEvent.ts = std::chrono::duration_cast<std::chrono::microseconds>(event.start - _origin).count();
+		traceEvent.dur = static_cast<int64_t>(event.pauseNs / 1000);
+		traceEvent.args = {
+			{ "generation", std::to_string(event.generation) },
+			{ "collect_us", std::to_string(event.collectNs / 1000) },
+			{ "heap_before", std::to_string(event.heapBefore) },
+			{ "heap_after", std::to_string(event.heapAfter) },
+		};
+	}
+	return traceEvents;
+}
+
+bool GcMonitor::WriteTrace(const fs::path& path) {
+	return WriteTraceFile(path, GetTraceEvents());
+}
+
+std::string GcMonitor::Report() {
+	GcSummary summary = GetSummary();
+	return std::format("collections {} (minor {}, major {}), {:.1f}/min, pause p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms, total {:.3f} ms, heap {} bytes",
+					   summary.collections, summary.minorCollections, summary.majorCollections, summary.collectionsPerMinute,
+					   static_cast<double>(summary.pauseP50Ns) / 1e6, static_cast<double>(summary.pauseP99Ns) / 1e6,
+					   static_cast<double>(summary.pauseMaxNs) / 1e6, static_cast<double>(summary.pauseTotalNs) / 1e6, summary.heapSize);
+}
+
+void GcMonitor::Reset() {
+	std::lock_guard lock(_mutex);
+	_origin = TraceClock::now();
+	_events.clear();
+	_next = 0;
+	_pauses = LatencyHistogram{};
+	_totals = GcSummary{};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "call_stats.h"
+#include "trace.h"
+
+namespace monolm {
+	struct GcProfilerCallbacks;
+
+	/// One stop-the-world pause of the garbage collector.
+	struct GcEvent {
+		TraceClock::time_point start;
+		uint64_t pauseNs{};   // world stopped until resumed
+		uint64_t collectNs{}; // collection itself, without suspending and resuming threads
+		int32_t generation{}; // 0 for nursery collections
+		int64_t heapBefore{};
+		int64_t heapAfter{};
+	};
+
+	/// Layout shared with Plugify.GcSummary and MonoLM_GetGcSummary, append new fields at the end.
+	struct GcSummary {
+		int64_t collections;
+		int64_t minorCollections;
+		int64_t majorCollections;
+		int64_t pauseP50Ns;
+		int64_t pauseP99Ns;
+		int64_t pauseMaxNs;
+		int64_t pauseTotalNs;
+		double collectionsPerMinute; // over the last minute
+		int64_t heapSize;
+	};
+
+	/// Records garbage collector pauses from profiler events into a ring of recent events and running counters.
+	class GcMonitor {
+	public:
+		static constexpr size_t kCapacity = 4096;
+
+		GcMonitor() = default;
+		~GcMonitor() = default;
+
+		void Enable();
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		GcSummary GetSummary();
+		/// Recent events, oldest first.
+		std::vector<GcEvent> GetEvents();
+		/// Recent events as Chrome trace events, one complete event per pause.
+		std::vector<TraceEvent> GetTraceEvents();
+		bool WriteTrace(const fs::path& path);
+		std::string Report();
+		void Reset();
+
+	private:
+		friend struct GcProfilerCallbacks;
+
+		void HandleEvent(int event, uint32_t generation);
+
+		std::atomic<bool> _enabled{ false };
+		TraceClock::time_point _origin;
+
+		// Written by the collecting thread while it holds the GC lock
+		GcEvent _current;
+		TraceClock::time_point _collectStart;
+		bool _collecting{ false };
+
+		std::mutex _mutex;
+		std::vector<GcEvent> _events;
+		size_t _next{ 0 };
+		LatencyHistogram _pauses;
+		GcSummary _totals{};
+	};
+}
@@ -26,6 +26,148 @@ bool Core_IsPluginLoaded(MonoString* name, int32_t version, bool minimum) {
 	return g_monolm.GetProvider()->IsPluginLoaded(MonoStringToUTF8(name), requiredVersion, minimum);
 }
 
+bool Core_ActivateDebugging() {
+	return g_monolm.ActivateDebugging();
+}
+
+bool Core_IsDebuggingActive() {
+	return g_monolm.IsDebuggingActive();
+}
+
+bool Core_ReleaseDelegate(MonoObject* delegate) {
+	return g_monolm.ReleaseDelegate(delegate);
+}
+
+void Core_HandleException(MonoObject* exception) {
+	g_monolm.ReportException(exception);
+}
+
+MonoString* Core_GetCallStats() {
+	CallStats& stats = g_monolm.GetCallStats();
+	if (!stats.IsEnabled())
+		return nullptr;
+	return g_monolm.CreateString(stats.Report());
+}
+
+void Core_ResetCallStats() {
+	g_monolm.GetCallStats().Reset();
+}
+
+MonoString* Core_GetAllocStats() {
+	AllocStats& stats = g_monolm.GetAllocStats();
+	if (!stats.IsEnabled())
+		return nullptr;
+	return g_monolm.CreateString(stats.Report());
+}
+
+void Core_ResetAllocStats() {
+	g_monolm.GetAllocStats().Reset();
+}
+
+bool Core_GetGcSummary(GcSummary* summary) {
+	GcMonitor& monitor = g_monolm.GetGcMonitor();
+	if (!monitor.IsEnabled()) {
+		*summary = GcSummary{};
+		return false;
+	}
+	*summary = monitor.GetSummary();
+	return true;
+}
+
+bool Core_WriteGcTrace(MonoString* path) {
+	GcMonitor& monitor = g_monolm.GetGcMonitor();
+	if (!monitor.IsEnabled())
+		return false;
+#if MONOLM_PLATFORM_WINDOWS
+	auto str = MonoStringToUTF16(path);
+#else
+	auto str = MonoStringToUTF8(path);
+#endif
+	return monitor.WriteTrace(fs::path(std::basic_string_view(str.data(), str.size())));
+}
+
+void Core_ResetGcStats() {
+	g_monolm.GetGcMonitor().Reset();
+}
+
+bool Core_IsTimeAccountingEnabled() {
+	return g_monolm.GetTimeAccounting().IsEnabled();
+}
+
+void Core_EnterPlugin(MonoObject* plugin, bool fixedUpdate) {
+	TimeAccounting& accounting = g_monolm.GetTimeAccounting();
+	MonoImage* image = mono_class_get_image(mono_object_get_class(plugin));
+	accounting.Enter(accounting.FindAccount(image), TimeKind::Lifecycle, fixedUpdate ? "OnFixedUpdate" : "OnUpdate", true);
+}
+
+void Core_LeavePlugin() {
+	g_monolm.GetTimeAccounting().Leave();
+}
+
+MonoString* Core_GetTimeStats() {
+	TimeAccounting& accounting = g_monolm.GetTimeAccounting();
+	if (!accounting.IsEnabled())
+		return nullptr;
+	return g_monolm.CreateString(accounting.Report());
+}
+
+void Core_ResetTimeStats() {
+	g_monolm.GetTimeAccounting().Reset();
+}
+
+MonoString* Core_TakeHeapSnapshot() {
+	if (!g_monolm.IsHeapSnapshotEnabled())
+		return nullptr;
+	std::string snapshot = g_monolm.TakeHeapSnapshot();
+	return !snapshot.empty() ? g_monolm.CreateString(snapshot) : nullptr;
+}
+
+bool Profiler_Start() {
+	return g_monolm.GetSamplingProfiler().Start();
+}
+
+void Profiler_Stop() {
+	g_monolm.GetSamplingProfiler().Stop();
+}
+
+bool Profiler_IsRunning() {
+	return g_monolm.GetSamplingProfiler().IsRunning();
+}
+
+MonoString* Profiler_GetCollapsedStacks() {
+	SamplingProfiler& profiler = g_monolm.GetSamplingProfiler();
+	if (!profiler.IsEnabled())
+		return nullptr;
+	return g_monolm.CreateString(profiler.GetCollapsedStacks());
+}
+
+MonoString* Profiler_GetSpeedscope() {
+	SamplingProfiler& profiler = g_monolm.GetSamplingProfiler();
+	if (!profiler.IsEnabled())
+		return nullptr;
+	return g_monolm.CreateString(profiler.GetSpeedscope());
+}
+
+void Profiler_Reset() {
+	g_monolm.GetSamplingProfiler().Reset();
+}
+
+void Scheduler_PostWorker(MonoObject* job) {
+	g_monolm.GetScheduler().PostWorker(mono_gchandle_new(job, false));
+}
+
+void Scheduler_PostMain(MonoObject* job) {
+	g_monolm.GetScheduler().PostMain(mono_gchandle_new(job, false));
+}
+
+bool Scheduler_IsMainThread() {
+	return g_monolm.GetScheduler().IsMainThread();
+}
+
+int32_t Scheduler_GetWorkerCount() {
+	return static_cast<int32_t>(g_monolm.GetScheduler().GetWorkerCount());
+}
+
 MonoString* Plugin_FindResource(int64_t id, MonoString* path) {
 	ScriptInstance* script = g_monolm.FindScript(id);
 	if (script) {
@@ -46,5 +188,34 @@ void Glue::RegisterFunctions() {
 	PLUG_ADD_INTERNAL_CALL(Core_GetBaseDirectory);
 	PLUG_ADD_INTERNAL_CALL(Core_IsModuleLoaded);
 	PLUG_ADD_INTERNAL_CALL(Core_IsPluginLoaded);
+	PLUG_ADD_INTERNAL_CALL(Core_ActivateDebugging);
+	PLUG_ADD_INTERNAL_CALL(Core_IsDebuggingActive);
+	PLUG_ADD_INTERNAL_CALL(Core_ReleaseDelegate);
+	PLUG_ADD_INTERNAL_CALL(Core_HandleException);
+	PLUG_ADD_INTERNAL_CALL(Core_GetCallStats);
+	PLUG_ADD_INTERNAL_CALL(Core_ResetCallStats);
+	PLUG_ADD_INTERNAL_CALL(Core_GetAllocStats);
+	PLUG_ADD_INTERNAL_CALL(Core_ResetAllocStats);
+	PLUG_ADD_INTERNAL_CALL(Core_GetGcSummary);
+	PLUG_ADD_INTERNAL_CALL(Core_WriteGcTrace);
+	PLUG_ADD_INTERNAL_CALL(Core_ResetGcStats);
+	PLUG_ADD_INTERNAL_CALL(Core_IsTimeAccountingEnabled);
+	PLUG_ADD_INTERNAL_CALL(Core_EnterPlugin);
+	PLUG_ADD_INTERNAL_CALL(Core_LeavePlugin);
+	PLUG_ADD_INTERNAL_CALL(Core_GetTimeStats);
+	PLUG_ADD_INTERNAL_CALL(Core_ResetTimeStats);
+	PLUG_ADD_INTERNAL_CALL(Core_TakeHeapSnapshot);
 	PLUG_ADD_INTERNAL_CALL(Plugin_FindResource);
+
+	PLUG_ADD_INTERNAL_CALL(Profiler_Start);
+	PLUG_ADD_INTERNAL_CALL(Profiler_Stop);
+	PLUG_ADD_INTERNAL_CALL(Profiler_IsRunning);
+	PLUG_ADD_INTERNAL_CALL(Profiler_GetCollapsedStacks);
+	PLUG_ADD_INTERNAL_CALL(Profiler_GetSpeedscope);
+	PLUG_ADD_INTERNAL_CALL(Profiler_Reset);
+
+	PLUG_ADD_INTERNAL_CALL(Scheduler_PostWorker);
+	PLUG_ADD_INTERNAL_CALL(Scheduler_PostMain);
+	PLUG_ADD_INTERNAL_CALL(Scheduler_IsMainThread);
+	PLUG_ADD_INTERNAL_CALL(Scheduler_GetWorkerCount);
 }
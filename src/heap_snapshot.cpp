@@ -0,0 +1,175 @@
+#include "heap_snapshot.h"
+
+#include <mono/metadata/class.h>
+#include <mono/metadata/image.h>
+#include <mono/metadata/mono-gc.h>
+#include <mono/metadata/profiler.h>
+#include <mono/utils/mono-publib.h>
+
+using namespace monolm;
+
+namespace {
+	constexpr std::string_view kHandleNames[] = { "weak", "weak_track_resurrection", "normal", "pinned" };
+
+	size_t HashClass(MonoClass* klass) {
+		// Classes are at least pointer aligned, the low bits carry no information
+		auto value = reinterpret_cast<uintptr_t>(klass) >> 3;
+		return static_cast<size_t>(value * 0x9E3779B97F4A7C15ull);
+	}
+}
+
+struct monolm::HeapProfilerCallbacks {
+	static void OnGcEvent(MonoProfiler* profiler, MonoProfilerGCEvent event, uint32_t generation, mono_bool /*isSerial*/) {
+		reinterpret_cast<HeapSnapshot*>(profiler)->HandleEvent(event, generation);
+	}
+
+	static void OnHandleCreated(MonoProfiler* profiler, uint32_t /*handle*/, MonoGCHandleType type, MonoObject* /*object*/) {
+		auto& handles = reinterpret_cast<HeapSnapshot*>(profiler)->_handles;
+		if (static_cast<size_t>(type) < handles.size()) {
+			handles[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	static void OnHandleDeleted(MonoProfiler* profiler, uint32_t /*handle*/, MonoGCHandleType type) {
+		auto& handles = reinterpret_cast<HeapSnapshot*>(profiler)->_handles;
+		if (static_cast<size_t>(type) < handles.size()) {
+			handles[static_cast<size_t>(type)].fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	static int OnObject(MonoObject* /*object*/, MonoClass* klass, uintptr_t size, uintptr_t /*num*/, MonoObject** /*refs*/, uintptr_t* /*offsets*/, void* data) {
+		// Objects with many references are reported in several chunks, only the first one carries the size
+		if (size != 0) {
+			static_cast<HeapSnapshot*>(data)->AddObject(klass, size);
+		}
+		return 0;
+	}
+};
+
+void HeapSnapshot::Enable() {
+	if (_enabled)
+		return;
+
+	// Profiler handles live until the runtime shuts down
+	MonoProfilerHandle handle = mono_profiler_create(reinterpret_cast<MonoProfiler*>(this));
+	mono_profiler_set_gc_event_callback(handle, &HeapProfilerCallbacks::OnGcEvent);
+	mono_profiler_set_gc_handle_created_callback(handle, &HeapProfilerCallbacks::OnHandleCreated);
+	mono_profiler_set_gc_handle_deleted_callback(handle, &HeapProfilerCallbacks::OnHandleDeleted);
+	_enabled = true;
+}
+
+void HeapSnapshot::AddImage(MonoImage* image, std::string owner) {
+	std::lock_guard lock(_mutex);
+	_images.try_emplace(image, std::move(owner));
+}
+
+void HeapSnapshot::HandleEvent(int event, uint32_t generation) {
+	// The heap can only be walked while the world is still stopped after the collection. A nursery collection running
+	// before the requested major one leaves the request pending, its heap still holds unreachable objects.
+	if (event != MONO_GC_EVENT_PRE_START_WORLD || generation != static_cast<uint32_t>(mono_gc_max_generation()))
+		return;
+	if (_walkRequested.exchange(false, std::memory_order_acquire)) {
+		mono_gc_walk_heap(0, &HeapProfilerCallbacks::OnObject, this);
+		_walked = true;
+	}
+}
+
+void HeapSnapshot::AddObject(MonoClass* klass, uint64_t size) {
+	for (size_t i = HashClass(klass), probes = 0; probes < kMaxClasses; ++i, ++probes) {
+		ClassEntry& entry = _classes[i & (kMaxClasses - 1)];
+		if (entry.klass == nullptr) {
+			entry.klass = klass;
+		} else if (entry.klass != klass) {
+			continue;
+		}
+		++entry.objects;
+		entry.bytes += size;
+		return;
+	}
+	++_other.objects;
+	_other.bytes += size;
+}
+
+std::string HeapSnapshot::Take(std::span<const NativeFigure> native) {
+	if (!IsEnabled())
+		return {};
+
+	std::lock_guard lock(_mutex);
+
+	if (!_classes) {
+		_classes = std::make_unique<ClassEntry[]>(kMaxClasses);
+	} else {
+		std::fill_n(_classes.get(), kMaxClasses, ClassEntry{});
+	}
+	_other = ClassEntry{};
+	_walked = false;
+
+	_walkRequested.store(true, std::memory_order_release);
+	mono_gc_collect(mono_gc_max_generation());
+	_walkRequested.store(false, std::memory_order_relaxed);
+
+	struct Row {
+		std::string_view owner;
+		std::string assembly;
+		std::string type;
+		uint64_t objects;
+		uint64_t bytes;
+	};
+
+	std::vector<Row> rows;
+	std::map<std::string_view, std::pair<uint64_t, uint64_t>> owners;
+	uint64_t totalObjects = _other.objects;
+	uint64_t totalBytes = _other.bytes;
+
+	if (_walked) {
+		for (size_t i = 0; i < kMaxClasses; ++i) {
+			const ClassEntry& entry = _classes[i];
+			if (!entry.klass)
+				continue;
+
+			MonoImage* image = mono_class_get_image(entry.klass);
+			auto it = _images.find(image);
+			std::string_view owner = it != _images.end() ? std::string_view(it->second) : "[runtime]";
+
+			char* typeName = mono_type_get_name(mono_class_get_type(entry.klass));
+			rows.push_back(Row{ owner, mono_image_get_name(image), typeName, entry.objects, entry.bytes });
+			mono_free(typeName);
+
+			auto& [objects, bytes] = owners[owner];
+			objects += entry.objects;
+			bytes += entry.bytes;
+			totalObjects += entry.objects;
+			totalBytes += entry.bytes;
+		}
+	}
+
+	// Sorted by name rather than size, so the same type stays on the same line across snapshots
+	std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+		return std::tie(a.owner, a.assembly, a.type) < std::tie(b.owner, b.assembly, b.type);
+	});
+
+	std::string report;
+	auto out = std::back_inserter(report);
+	if (!_walked) {
+		std::format_to(out, "# heap walk did not run, only native figures are valid\n");
+	}
+	std::format_to(out, "heap\tsize\t{}\n", mono_gc_get_heap_size());
+	std::format_to(out, "heap\tobjects\t{}\n", totalObjects);
+	std::format_to(out, "heap\tbytes\t{}\n", totalBytes);
+	for (size_t i = 0; i < _handles.size(); ++i) {
+		std::format_to(out, "gchandle\t{}\t{}\n", kHandleNames[i], _handles[i].load(std::memory_order_relaxed));
+	}
+	for (const auto& [name, value] : native) {
+		std::format_to(out, "native\t{}\t{}\n", name, value);
+	}
+	for (const auto& [owner, totals] : owners) {
+		std::format_to(out, "plugin\t{}\t{}\t{}\n", owner, totals.first, totals.second);
+	}
+	for (const Row& row : rows) {
+		std::format_to(out, "type\t{}\t{}\t{}\t{}\t{}\n", row.owner, row.assembly, row.type, row.objects, row.bytes);
+	}
+	if (_other.objects != 0) {
+		std::format_to(out, "type\t[other]\t\t\t{}\t{}\n", _other.objects, _other.bytes);
+	}
+	return report;
+}
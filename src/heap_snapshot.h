@@ -0,0 +1,60 @@
+#pragma once
+
+extern "C" {
+	typedef struct _MonoClass MonoClass;
+	typedef struct _MonoImage MonoImage;
+	typedef struct _MonoObject MonoObject;
+}
+
+namespace monolm {
+	struct HeapProfilerCallbacks;
+
+	/// Named figure of the module appended to a snapshot, e.g. JIT code bytes or a cache size.
+	using NativeFigure = std::pair<std::string_view, int64_t>;
+
+	/// Counts live managed objects by type and owning plugin with a heap walk after a full collection, and tracks the
+	/// number of GC handles held per handle type. Snapshots are plain text with one tab separated line per entry in a
+	/// stable order, so two snapshots can be compared with diff.
+	class HeapSnapshot {
+	public:
+		/// Classes tracked per snapshot, objects of further classes are counted as "[other]".
+		static constexpr size_t kMaxClasses = size_t{ 1 } << 16;
+
+		HeapSnapshot() = default;
+		~HeapSnapshot() = default;
+
+		/// Registers the profiler, call before mono_jit_init so handles created during startup are counted.
+		void Enable();
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		/// Objects of classes from the image are attributed to owner, all others to "[runtime]".
+		void AddImage(MonoImage* image, std::string owner);
+
+		/// Forces a full collection and walks the surviving objects, call from a thread attached to the runtime.
+		std::string Take(std::span<const NativeFigure> native);
+
+	private:
+		friend struct HeapProfilerCallbacks;
+
+		struct ClassEntry {
+			MonoClass* klass;
+			uint64_t objects;
+			uint64_t bytes;
+		};
+
+		void HandleEvent(int event, uint32_t generation);
+		void AddObject(MonoClass* klass, uint64_t size);
+
+		std::atomic<bool> _enabled{ false };
+		std::array<std::atomic<int64_t>, 4> _handles{}; // by MonoGCHandleType
+
+		std::mutex _mutex;
+		std::unordered_map<MonoImage*, std::string> _images;
+
+		// Filled while the world is stopped, so the table is allocated up front and probed without locks
+		std::unique_ptr<ClassEntry[]> _classes;
+		ClassEntry _other{};
+		std::atomic<bool> _walkRequested{ false };
+		bool _walked{ false };
+	};
+}
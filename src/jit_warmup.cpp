@@ -0,0 +1,164 @@
+#include "jit_warmup.h"
+
+#include <mono/metadata/class.h>
+#include <mono/metadata/image.h>
+#include <mono/metadata/loader.h>
+#include <mono/metadata/object.h>
+#include <mono/metadata/profiler.h>
+#include <mono/metadata/threads.h>
+
+#include <charconv>
+
+using namespace monolm;
+
+void JitWarmup::Enable() {
+	if (_enabled)
+		return;
+
+	// Profiler handles live until the runtime shuts down
+	MonoProfilerHandle handle = mono_profiler_create(reinterpret_cast<MonoProfiler*>(this));
+	mono_profiler_set_jit_done_callback(handle, &OnJitDone);
+	_enabled = true;
+}
+
+void JitWarmup::OnJitDone(MonoProfiler* profiler, MonoMethod* method, MonoJitInfo* /*jinfo*/) {
+	auto* self = reinterpret_cast<JitWarmup*>(profiler);
+	MonoImage* image = mono_class_get_image(mono_method_get_class(method));
+
+	std::lock_guard lock(self->_mutex);
+	auto it = self->_images.find(image);
+	if (it != self->_images.end()) {
+		std::get<ImageProfile>(*it).methods.insert(method);
+	}
+}
+
+size_t JitWarmup::Track(MonoDomain* domain, MonoImage* image, fs::path profilePath) {
+	if (!_enabled)
+		return 0;
+
+	ImageProfile profile;
+	profile.path = std::move(profilePath);
+
+	// First line is the module version id, profiles of other builds of the assembly are ignored
+	std::ifstream istream(profile.path);
+	std::string guid;
+	if (istream.is_open() && std::getline(istream, guid) && guid == mono_image_get_guid(image)) {
+		std::string line;
+		while (std::getline(istream, line)) {
+			uint32_t token = 0;
+			auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), token, 16);
+			if (ec == std::errc{}) {
+				profile.tokens.insert(token);
+			}
+		}
+	}
+
+	WarmupJob job{ domain, image, { profile.tokens.begin(), profile.tokens.end() } };
+	size_t count = job.tokens.size();
+
+	std::lock_guard lock(_mutex);
+	_images.insert_or_assign(image, std::move(profile));
+
+	if (count != 0) {
+		_jobs.emplace_back(std::move(job));
+		if (!_worker.joinable()) {
+			_worker = std::thread(&JitWarmup::Run, this);
+		}
+		_condition.notify_one();
+	}
+
+	return count;
+}
+
+bool JitWarmup::Save(MonoImage* image) {
+	std::unique_lock lock(_mutex);
+	auto it = _images.find(image);
+	if (it == _images.end())
+		return false;
+
+	// Methods compiled since the last save are folded into the tokens, the set only grows while recording
+	ImageProfile& profile = std::get<ImageProfile>(*it);
+	std::vector<MonoMethod*> methods(profile.methods.begin(), profile.methods.end());
+	profile.methods.clear();
+	lock.unlock();
+
+	std::vector<uint32_t> tokens;
+	for (MonoMethod* method : methods) {
+		// Skips wrappers and generic instances, only methods which can be looked up by token are kept
+		uint32_t token = mono_method_get_token(method);
+		if (token != 0 && mono_get_method(image, token, nullptr) == method) {
+			tokens.push_back(token);
+		}
+	}
+
+	lock.lock();
+	it = _images.find(image);
+	if (it == _images.end())
+		return false;
+	ImageProfile& current = std::get<ImageProfile>(*it);
+	current.tokens.insert(tokens.begin(), tokens.end());
+	std::vector<uint32_t> saved(current.tokens.begin(), current.tokens.end());
+	fs::path path = current.path;
+	lock.unlock();
+
+	std::ofstream ostream(path, std::ios::trunc);
+	if (!ostream.is_open())
+		return false;
+
+	ostream << mono_image_get_guid(image) << '\n';
+	for (uint32_t token : saved) {
+		ostream << std::hex << token << '\n';
+	}
+	return ostream.good();
+}
+
+void JitWarmup::Untrack(MonoImage* image) {
+	std::lock_guard lock(_mutex);
+	_images.erase(image);
+}
+
+void JitWarmup::Stop() {
+	{
+		std::lock_guard lock(_mutex);
+		_stop = true;
+		_jobs.clear();
+	}
+	_condition.notify_all();
+
+	if (_worker.joinable()) {
+		_worker.join();
+	}
+
+	std::lock_guard lock(_mutex);
+	_images.clear();
+	_stop = false;
+}
+
+void JitWarmup::Run() {
+	while (true) {
+		WarmupJob job;
+		{
+			std::unique_lock lock(_mutex);
+			_condition.wait(lock, [this] { return _stop || !_jobs.empty(); });
+			if (_stop)
+				return;
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		// Attached only while compiling, so an idle worker never holds up the GC
+		MonoThread* thread = mono_thread_attach(job.domain);
+
+		for (uint32_t token : job.tokens) {
+			if (_stop)
+				break;
+
+			MonoMethod* method = mono_get_method(job.image, token, nullptr);
+			if (method) {
+				mono_compile_method(method);
+			}
+		}
+
+		mono_thread_detach(thread);
+	}
+}
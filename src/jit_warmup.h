@@ -0,0 +1,54 @@
+#pragma once
+
+extern "C" {
+	typedef struct _MonoDomain MonoDomain;
+	typedef struct _MonoImage MonoImage;
+	typedef struct _MonoMethod MonoMethod;
+	typedef struct _MonoJitInfo MonoJitInfo;
+	typedef struct _MonoProfiler MonoProfiler;
+}
+
+namespace monolm {
+	/// Records methods JIT-compiled from plugin images and precompiles them on a background thread in the next session.
+	class JitWarmup {
+	public:
+		JitWarmup() = default;
+		~JitWarmup() = default;
+
+		void Enable();
+		bool IsEnabled() const { return _enabled; }
+
+		/// Starts recording for the image and queues methods from its previous profile, returns the number of queued methods.
+		size_t Track(MonoDomain* domain, MonoImage* image, fs::path profilePath);
+		/// Writes the profile recorded so far next to the assembly, recording goes on until Untrack.
+		bool Save(MonoImage* image);
+		void Untrack(MonoImage* image);
+		void Stop();
+
+	private:
+		void Run();
+
+		static void OnJitDone(MonoProfiler* profiler, MonoMethod* method, MonoJitInfo* jinfo);
+
+		struct ImageProfile {
+			fs::path path;
+			std::unordered_set<uint32_t> tokens;
+			std::unordered_set<MonoMethod*> methods;
+		};
+
+		struct WarmupJob {
+			MonoDomain* domain{ nullptr };
+			MonoImage* image{ nullptr };
+			std::vector<uint32_t> tokens;
+		};
+
+		bool _enabled{ false };
+		std::unordered_map<MonoImage*, ImageProfile> _images;
+		std::mutex _mutex;
+
+		std::thread _worker;
+		std::deque<WarmupJob> _jobs;
+		std::condition_variable _condition;
+		std::atomic<bool> _stop{ false };
+	};
+}
@@ -0,0 +1,71 @@
+#include "method_index.h"
+
+#include <mono/metadata/class.h>
+#include <mono/metadata/image.h>
+#include <mono/metadata/loader.h>
+#include <mono/metadata/metadata.h>
+#include <mono/metadata/tokentype.h>
+
+using namespace monolm;
+
+namespace {
+	void AppendTypeName(std::string& buffer, MonoClass* klass) {
+		MonoClass* nestingClass = mono_class_get_nesting_type(klass);
+		if (nestingClass) {
+			AppendTypeName(buffer, nestingClass);
+			buffer += '/';
+		} else {
+			std::string_view nameSpace(mono_class_get_namespace(klass));
+			if (!nameSpace.empty()) {
+				buffer += nameSpace;
+				buffer += '.';
+			}
+		}
+		buffer += mono_class_get_name(klass);
+	}
+}
+
+MethodIndex::MethodIndex(MonoImage* image) {
+	int numTypes = mono_image_get_table_rows(image, MONO_TABLE_TYPEDEF);
+	_methods.reserve(static_cast<size_t>(numTypes) * 4);
+
+	// Row 1 is the <Module> pseudo type
+	for (int i = 2; i <= numTypes; ++i) {
+		MonoClass* klass = mono_class_get(image, MONO_TOKEN_TYPE_DEF | static_cast<uint32_t>(i));
+		if (klass) {
+			AddClass(klass);
+		}
+	}
+}
+
+void MethodIndex::AddClass(MonoClass* klass) {
+	_nameBuffer.clear();
+	AppendTypeName(_nameBuffer, klass);
+	_nameBuffer += '.';
+	size_t prefixSize = _nameBuffer.size();
+
+	void* iter = nullptr;
+	while (MonoMethod* method = mono_class_get_methods(klass, &iter)) {
+		MonoMethodSignature* sig = mono_method_signature(method);
+		if (!sig)
+			continue;
+
+		_nameBuffer.resize(prefixSize);
+		_nameBuffer += mono_method_get_name(method);
+
+		uint32_t arity = mono_signature_get_param_count(sig);
+
+		auto it = _methods.find(MethodKeyView{ _nameBuffer, arity });
+		if (it == _methods.end()) {
+			it = _methods.emplace(MethodKey{ _nameBuffer, arity }, std::vector<MonoMethod*>{}).first;
+		}
+		std::get<std::vector<MonoMethod*>>(*it).push_back(method);
+	}
+}
+
+std::span<MonoMethod* const> MethodIndex::Find(std::string_view name, uint32_t arity) const {
+	auto it = _methods.find(MethodKeyView{ name, arity });
+	if (it != _methods.end())
+		return std::get<std::vector<MonoMethod*>>(*it);
+	return {};
+}
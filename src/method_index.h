@@ -0,0 +1,59 @@
+#pragma once
+
+extern "C" {
+	typedef struct _MonoImage MonoImage;
+	typedef struct _MonoClass MonoClass;
+	typedef struct _MonoMethod MonoMethod;
+}
+
+namespace monolm {
+	/// Lookup of every method of an image by "Namespace.Class.Method" (or "Namespace.Outer/Inner.Method") and arity.
+	class MethodIndex {
+	public:
+		explicit MethodIndex(MonoImage* image);
+		~MethodIndex() = default;
+
+		/// Returns all overloads with the given name and parameter count.
+		std::span<MonoMethod* const> Find(std::string_view name, uint32_t arity) const;
+
+		size_t GetSize() const { return _methods.size(); }
+
+	private:
+		void AddClass(MonoClass* klass);
+
+		struct MethodKey {
+			std::string name;
+			uint32_t arity{};
+		};
+
+		struct MethodKeyView {
+			std::string_view name;
+			uint32_t arity{};
+		};
+
+		struct MethodKeyHash {
+			using is_transparent = void;
+
+			size_t operator()(MethodKeyView key) const noexcept {
+				size_t hash = std::hash<std::string_view>{}(key.name);
+				return hash ^ (std::hash<uint32_t>{}(key.arity) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+			}
+
+			size_t operator()(const MethodKey& key) const noexcept {
+				return (*this)(MethodKeyView{ key.name, key.arity });
+			}
+		};
+
+		struct MethodKeyEqual {
+			using is_transparent = void;
+
+			template<typename L, typename R>
+			bool operator()(const L& lhs, const R& rhs) const noexcept {
+				return lhs.arity == rhs.arity && std::string_view(lhs.name) == std::string_view(rhs.name);
+			}
+		};
+
+		std::unordered_map<MethodKey, std::vector<MonoMethod*>, MethodKeyHash, MethodKeyEqual> _methods;
+		std::string _nameBuffer;
+	};
+}
@@ -1,5 +1,6 @@
 #include "module.h"
 #include "glue.h"
+#include "method_index.h"
 #include "utils.h"
 
 #include <mono/jit/jit.h>
@@ -12,6 +13,7 @@
 #include <mono/metadata/mono-config.h>
 #include <mono/metadata/threads.h>
 #include <mono/metadata/exception.h>
+#include <mono/metadata/reflection.h>
 
 #include <plugify/log.h>
 #include <plugify/math.h>
@@ -22,10 +24,15 @@
 #include <cpptrace/cpptrace.hpp>
 #include <glaze/glaze.hpp>
 
+#include <charconv>
+#include <csignal>
+
 MONO_API MonoDelegate* mono_ftnptr_to_delegate(MonoClass* klass, void* ftn);
 MONO_API void* mono_delegate_to_ftnptr(MonoDelegate* delegate);
 //MONO_API void mono_delegate_free_ftnptr(MonoDelegate* delegate);
 MONO_API const void* mono_lookup_internal_call_full(MonoMethod* method, int warn_on_missing, mono_bool* uses_handles, mono_bool* foreign);
+MONO_API void* mono_threads_enter_gc_safe_region(void** stackdata);
+MONO_API void mono_threads_exit_gc_safe_region(void* cookie, void** stackdata);
 
 struct _MonoDelegate {
 	MonoObject object;
@@ -139,134 +146,106 @@ namespace {
 		return true;
 	}
 
-	struct string_hash {
-		using is_transparent = void;
-		[[nodiscard]] size_t operator()(const char* txt) const {
-			return std::hash<std::string_view>{}(txt);
+	/// Methods which Mono itself can expose through a reverse P/Invoke wrapper: primitives, char16 and references to them.
+	bool IsMethodDirectCapable(plugify::MethodRef method) {
+		if (!IsMethodPrimitive(method) || ValueUtils::IsStruct(method.GetReturnType().GetType()))
+			return false;
+
+		for (const auto& param : method.GetParamTypes()) {
+			if (ValueUtils::IsStruct(param.GetType()))
+				return false;
 		}
-		[[nodiscard]] size_t operator()(std::string_view txt) const {
-			return std::hash<std::string_view>{}(txt);
+
+		return true;
+	}
+
+	ValueType MonoPrimitiveToValueType(int typeEnum) {
+		switch (typeEnum) {
+			case MONO_TYPE_VOID:
+				return ValueType::Void;
+			case MONO_TYPE_BOOLEAN:
+				return ValueType::Bool;
+			case MONO_TYPE_CHAR:
+				return ValueType::Char16;
+			case MONO_TYPE_I1:
+				return ValueType::Int8;
+			case MONO_TYPE_I2:
+				return ValueType::Int16;
+			case MONO_TYPE_I4:
+				return ValueType::Int32;
+			case MONO_TYPE_I8:
+				return ValueType::Int64;
+			case MONO_TYPE_U1:
+				return ValueType::UInt8;
+			case MONO_TYPE_U2:
+				return ValueType::UInt16;
+			case MONO_TYPE_U4:
+				return ValueType::UInt32;
+			case MONO_TYPE_U8:
+				return ValueType::UInt64;
+			case MONO_TYPE_I:
+			case MONO_TYPE_U:
+				return ValueType::Pointer;
+			case MONO_TYPE_R4:
+				return ValueType::Float;
+			case MONO_TYPE_R8:
+				return ValueType::Double;
+			case MONO_TYPE_STRING:
+				return ValueType::String;
+			default:
+				return ValueType::Invalid;
 		}
-		[[nodiscard]] size_t operator()(const std::string& txt) const {
-			return std::hash<std::string>{}(txt);
+	}
+
+	ValueType MonoElementToArrayValueType(MonoClass* elementClass) {
+		switch (MonoPrimitiveToValueType(mono_type_get_type(mono_class_get_type(elementClass)))) {
+			case ValueType::Bool:
+				return ValueType::ArrayBool;
+			case ValueType::Char16:
+				return ValueType::ArrayChar16;
+			case ValueType::Int8:
+				return ValueType::ArrayInt8;
+			case ValueType::Int16:
+				return ValueType::ArrayInt16;
+			case ValueType::Int32:
+				return ValueType::ArrayInt32;
+			case ValueType::Int64:
+				return ValueType::ArrayInt64;
+			case ValueType::UInt8:
+				return ValueType::ArrayUInt8;
+			case ValueType::UInt16:
+				return ValueType::ArrayUInt16;
+			case ValueType::UInt32:
+				return ValueType::ArrayUInt32;
+			case ValueType::UInt64:
+				return ValueType::ArrayUInt64;
+			case ValueType::Pointer:
+				return ValueType::ArrayPointer;
+			case ValueType::Float:
+				return ValueType::ArrayFloat;
+			case ValueType::Double:
+				return ValueType::ArrayDouble;
+			case ValueType::String:
+				return ValueType::ArrayString;
+			default:
+				return ValueType::Invalid;
 		}
-	};
+	}
 
-	ValueType MonoTypeToValueType(std::string_view typeName) {
-		static std::unordered_map<std::string, ValueType, string_hash, std::equal_to<>> valueTypeMap = {
-				{ "System.Void", ValueType::Void },
-				{ "System.Boolean", ValueType::Bool },
-				{ "System.Char", ValueType::Char16 },
-				{ "System.SByte", ValueType::Int8 },
-				{ "System.Int16", ValueType::Int16 },
-				{ "System.Int32", ValueType::Int32 },
-				{ "System.Int64", ValueType::Int64 },
-				{ "System.Byte", ValueType::UInt8 },
-				{ "System.UInt16", ValueType::UInt16 },
-				{ "System.UInt32", ValueType::UInt32 },
-				{ "System.UInt64", ValueType::UInt64 },
-				{ "System.IntPtr", ValueType::Pointer },
-				{ "System.UIntPtr", ValueType::Pointer },
-				{ "System.Single", ValueType::Float },
-				{ "System.Double", ValueType::Double },
-				{ "System.String", ValueType::String },
-				{ "System.Boolean[]", ValueType::ArrayBool },
-				{ "System.Char[]", ValueType::ArrayChar16 },
-				{ "System.SByte[]", ValueType::ArrayInt8 },
-				{ "System.Int16[]", ValueType::ArrayInt16 },
-				{ "System.Int32[]", ValueType::ArrayInt32 },
-				{ "System.Int64[]", ValueType::ArrayInt64 },
-				{ "System.Byte[]", ValueType::ArrayUInt8 },
-				{ "System.UInt16[]", ValueType::ArrayUInt16 },
-				{ "System.UInt32[]", ValueType::ArrayUInt32 },
-				{ "System.UInt64[]", ValueType::ArrayUInt64 },
-				{ "System.IntPtr[]", ValueType::ArrayPointer },
-				{ "System.UIntPtr[]", ValueType::ArrayPointer },
-				{ "System.Single[]", ValueType::ArrayFloat },
-				{ "System.Double[]", ValueType::ArrayDouble },
-				{ "System.String[]", ValueType::ArrayString },
-
-				{ "System.Boolean&", ValueType::Bool },
-				{ "System.Char&", ValueType::Char16 },
-				{ "System.SByte&", ValueType::Int8 },
-				{ "System.Int16&", ValueType::Int16 },
-				{ "System.Int32&", ValueType::Int32 },
-				{ "System.Int64&", ValueType::Int64 },
-				{ "System.Byte&", ValueType::UInt8 },
-				{ "System.UInt16&", ValueType::UInt16 },
-				{ "System.UInt32&", ValueType::UInt32 },
-				{ "System.UInt64&", ValueType::UInt64 },
-				{ "System.IntPtr&", ValueType::Pointer },
-				{ "System.UIntPtr&", ValueType::Pointer },
-				{ "System.Single&", ValueType::Float },
-				{ "System.Double&", ValueType::Double },
-				{ "System.String&", ValueType::String },
-				{ "System.Boolean[]&", ValueType::ArrayBool },
-				{ "System.Char[]&", ValueType::ArrayChar16 },
-				{ "System.SByte[]&", ValueType::ArrayInt8 },
-				{ "System.Int16[]&", ValueType::ArrayInt16 },
-				{ "System.Int32[]&", ValueType::ArrayInt32 },
-				{ "System.Int64[]&", ValueType::ArrayInt64 },
-				{ "System.Byte[]&", ValueType::ArrayUInt8 },
-				{ "System.UInt16[]&", ValueType::ArrayUInt16 },
-				{ "System.UInt32[]&", ValueType::ArrayUInt32 },
-				{ "System.UInt64[]&", ValueType::ArrayUInt64 },
-				{ "System.IntPtr[]&", ValueType::ArrayPointer },
-				{ "System.UIntPtr[]&", ValueType::ArrayPointer },
-				{ "System.Single[]&", ValueType::ArrayFloat },
-				{ "System.Double[]&", ValueType::ArrayDouble },
-				{ "System.String[]&", ValueType::ArrayString },
-
-				{ "System.Delegate", ValueType::Function },
-				{ "System.Func`1", ValueType::Function },
-				{ "System.Func`2", ValueType::Function },
-				{ "System.Func`3", ValueType::Function },
-				{ "System.Func`4", ValueType::Function },
-				{ "System.Func`5", ValueType::Function },
-				{ "System.Func`6", ValueType::Function },
-				{ "System.Func`7", ValueType::Function },
-				{ "System.Func`8", ValueType::Function },
-				{ "System.Func`9", ValueType::Function },
-				{ "System.Func`10", ValueType::Function },
-				{ "System.Func`11", ValueType::Function },
-				{ "System.Func`12", ValueType::Function },
-				{ "System.Func`13", ValueType::Function },
-				{ "System.Func`14", ValueType::Function },
-				{ "System.Func`15", ValueType::Function },
-				{ "System.Func`16", ValueType::Function },
-				{ "System.Func`17", ValueType::Function },
-				{ "System.Action", ValueType::Function },
-				{ "System.Action`1", ValueType::Function },
-				{ "System.Action`2", ValueType::Function },
-				{ "System.Action`3", ValueType::Function },
-				{ "System.Action`4", ValueType::Function },
-				{ "System.Action`5", ValueType::Function },
-				{ "System.Action`6", ValueType::Function },
-				{ "System.Action`7", ValueType::Function },
-				{ "System.Action`8", ValueType::Function },
-				{ "System.Action`9", ValueType::Function },
-				{ "System.Action`10", ValueType::Function },
-				{ "System.Action`11", ValueType::Function },
-				{ "System.Action`12", ValueType::Function },
-				{ "System.Action`13", ValueType::Function },
-				{ "System.Action`14", ValueType::Function },
-				{ "System.Action`15", ValueType::Function },
-				{ "System.Action`16", ValueType::Function },
-
-				{ "System.Numerics.Vector2", ValueType::Vector2 },
-				{ "System.Numerics.Vector3", ValueType::Vector3 },
-				{ "System.Numerics.Vector4", ValueType::Vector4 },
-				{ "System.Numerics.Matrix4x4", ValueType::Matrix4x4 },
-
-				{ "System.Numerics.Vector2&", ValueType::Vector2 },
-				{ "System.Numerics.Vector3&", ValueType::Vector3 },
-				{ "System.Numerics.Vector4&", ValueType::Vector4 },
-				{ "System.Numerics.Matrix4x4&", ValueType::Matrix4x4 },
-		};
-		auto it = valueTypeMap.find(typeName);
-		if (it != valueTypeMap.end())
-			return std::get<ValueType>(*it);
-		return ValueType::Invalid;
+	// Managed char is always UTF-16, char8 is declared by manifest only
+	ValueType AdjustCharType(ValueType monoType, ValueType manifestType) {
+		if (manifestType == ValueType::Char8 && monoType == ValueType::Char16)
+			return ValueType::Char8;
+		if (manifestType == ValueType::ArrayChar8 && monoType == ValueType::ArrayChar16)
+			return ValueType::ArrayChar8;
+		return monoType;
+	}
+
+	std::string GetTypeName(MonoType* type) {
+		char* typeName = mono_type_get_name(type);
+		std::string result(typeName ? typeName : "");
+		mono_free(typeName);
+		return result;
 	}
 
 	plg::string GetStringProperty(const char* propertyName, MonoClass* classType, MonoObject* classObject) {
@@ -277,20 +256,29 @@ namespace {
 	}
 
 	MonoAssembly* LoadMonoAssembly(const fs::path& assemblyPath, bool loadPDB, MonoImageOpenStatus& status) {
-		auto buffer = Utils::ReadBytes<char>(assemblyPath);
+		StartupProfiler& profiler = g_monolm.GetStartupProfiler();
+		std::string owner(profiler.IsEnabled() ? assemblyPath.stem().string() : std::string());
+
+		std::vector<char> buffer;
+		{
+			ScopedPhase phase(profiler, "ReadFile", "assembly", owner);
+			buffer = Utils::ReadBytes<char>(assemblyPath);
+		}
+
+		ScopedPhase phase(profiler, "OpenImage", "assembly", owner);
+
 		MonoImage* image = mono_image_open_from_data_full(buffer.data(), static_cast<uint32_t>(buffer.size()), 1, &status, 0);
 
 		if (status != MONO_IMAGE_OK)
 			return nullptr;
 
 		if (loadPDB) {
+			ScopedPhase pdbPhase(profiler, "LoadSymbols", "assembly", owner);
+
 			fs::path pdbPath(assemblyPath);
 			pdbPath.replace_extension(".pdb");
 
-			auto bytes = Utils::ReadBytes<mono_byte>(pdbPath);
-			mono_debug_open_image_from_memory(image, bytes.data(), static_cast<int>(bytes.size()));
-
-			// If pdf not load ?
+			g_monolm.LoadSymbols(image, std::move(pdbPath));
 		}
 		MonoAssembly* assembly = mono_assembly_load_from_full(image, assemblyPath.string().c_str(), &status, 0);
 		mono_image_close(image);
@@ -336,10 +324,88 @@ namespace {
 		return { klass, ctor };
 	}
 
+	template<typename T>
+	T LoadCoreThunk(std::vector<std::string>& errors, MonoClass* klass, std::string_view className, const char* name, int paramCount) {
+		MonoMethod* method = mono_class_get_method_from_name(klass, name, paramCount);
+		if (!method) {
+			errors.emplace_back(std::format("{}::{}", className, name));
+			return nullptr;
+		}
+		return reinterpret_cast<T>(mono_method_get_unmanaged_thunk(method));
+	}
+
+	/// Value type of a native argument copy, uintptr_t and uint64_t arrays share a type and count as ArrayUInt64.
+	template<typename T>
+	constexpr ValueType NativeValueType() {
+		if constexpr (std::same_as<T, plg::string>) return ValueType::String;
+		else if constexpr (std::same_as<T, std::vector<bool>>) return ValueType::ArrayBool;
+		else if constexpr (std::same_as<T, std::vector<char>>) return ValueType::ArrayChar8;
+		else if constexpr (std::same_as<T, std::vector<char16_t>>) return ValueType::ArrayChar16;
+		else if constexpr (std::same_as<T, std::vector<int8_t>>) return ValueType::ArrayInt8;
+		else if constexpr (std::same_as<T, std::vector<int16_t>>) return ValueType::ArrayInt16;
+		else if constexpr (std::same_as<T, std::vector<int32_t>>) return ValueType::ArrayInt32;
+		else if constexpr (std::same_as<T, std::vector<int64_t>>) return ValueType::ArrayInt64;
+		else if constexpr (std::same_as<T, std::vector<uint8_t>>) return ValueType::ArrayUInt8;
+		else if constexpr (std::same_as<T, std::vector<uint16_t>>) return ValueType::ArrayUInt16;
+		else if constexpr (std::same_as<T, std::vector<uint32_t>>) return ValueType::ArrayUInt32;
+		else if constexpr (std::same_as<T, std::vector<uint64_t>>) return ValueType::ArrayUInt64;
+		else if constexpr (std::same_as<T, std::vector<uintptr_t>>) return ValueType::ArrayPointer;
+		else if constexpr (std::same_as<T, std::vector<float>>) return ValueType::ArrayFloat;
+		else if constexpr (std::same_as<T, std::vector<double>>) return ValueType::ArrayDouble;
+		else if constexpr (std::same_as<T, std::vector<plg::string>>) return ValueType::ArrayString;
+		else if constexpr (std::same_as<T, plugify::Vector2>) return ValueType::Vector2;
+		else if constexpr (std::same_as<T, plugify::Vector3>) return ValueType::Vector3;
+		else if constexpr (std::same_as<T, plugify::Vector4>) return ValueType::Vector4;
+		else if constexpr (std::same_as<T, plugify::Matrix4x4>) return ValueType::Matrix4x4;
+		else return ValueType::Invalid;
+	}
+
+	/// Bytes held by a native argument copy: the object itself plus the payload it copied.
+	template<typename T>
+	size_t NativeSizeOf(const T& value) {
+		if constexpr (std::same_as<T, plg::string>) {
+			return sizeof(T) + value.size();
+		} else if constexpr (std::same_as<T, std::vector<bool>>) {
+			return sizeof(T) + (value.size() + 7) / 8;
+		} else if constexpr (std::same_as<T, std::vector<plg::string>>) {
+			size_t bytes = sizeof(T);
+			for (const auto& str : value) {
+				bytes += sizeof(plg::string) + str.size();
+			}
+			return bytes;
+		} else if constexpr (requires { value.data(); value.size(); }) {
+			return sizeof(T) + value.size() * sizeof(*value.data());
+		} else {
+			return sizeof(T);
+		}
+	}
+
+	/// Image declaring the target method of a delegate, read through Delegate.Method.DeclaringType.
+	MonoImage* GetDelegateImage(MonoObject* delegate) {
+		auto getProperty = [](MonoObject* object, const char* name) -> MonoObject* {
+			MonoProperty* property = mono_class_get_property_from_name(mono_object_get_class(object), name);
+			if (!property)
+				return nullptr;
+			MonoObject* exception = nullptr;
+			MonoObject* value = mono_property_get_value(property, object, nullptr, &exception);
+			return exception ? nullptr : value;
+		};
+
+		MonoObject* methodInfo = getProperty(delegate, "Method");
+		if (!methodInfo)
+			return nullptr;
+		MonoObject* declaringType = getProperty(methodInfo, "DeclaringType");
+		if (!declaringType)
+			return nullptr;
+		MonoType* type = mono_reflection_type_get_type(reinterpret_cast<MonoReflectionType*>(declaringType));
+		return mono_class_get_image(mono_class_from_mono_type(type));
+	}
+
 	template<typename T>
 	void* AllocateMemory(ArgumentList& args) {
 		void* ptr = std::malloc(sizeof(T));
 		args.push_back(ptr);
+		g_monolm.GetAllocStats().Record(AllocKind::Native, NativeValueType<T>(), sizeof(T));
 		return ptr;
 	}
 
@@ -349,12 +415,176 @@ namespace {
 		std::free(ptr);
 	}
 
+	// Wrappers of native functions passed to C# as delegates, freed with the delegate through the reference queues
+	std::atomic<int64_t> g_delegateCallbacks{ 0 };
+	std::atomic<int64_t> g_delegateCalls{ 0 };
+
 	void CallbackRefQueueCallback(void* callback) {
 		delete reinterpret_cast<JitCallback*>(callback);
+		g_delegateCallbacks.fetch_sub(1, std::memory_order_relaxed);
 	}
 
 	void CallRefQueueCallback(void* callback) {
 		delete reinterpret_cast<JitCall*>(callback);
+		g_delegateCalls.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/// Native code may not touch managed memory in GC safe mode, which rules out delegates and pointers into managed objects.
+	bool IsMethodGcSafeCapable(MethodRef method) {
+		if (method.GetReturnType().GetType() == ValueType::Function)
+			return false;
+		for (const auto& param : method.GetParamTypes()) {
+			ValueType type = param.GetType();
+			if (type == ValueType::Function || ValueUtils::IsBetween(type, ValueType::_StructStart, ValueType::_StructEnd))
+				return false;
+			if (param.IsReference() && ValueUtils::IsBetween(type, ValueType::_BaseStart, ValueType::_BaseEnd))
+				return false;
+		}
+		return true;
+	}
+
+	/// System.Numerics vector types live in corlib on newer profiles and in System.Numerics on the classic framework.
+	MonoImage* FindNumericsImage() {
+		if (mono_class_from_name(mono_get_corlib(), "System.Numerics", "Vector2"))
+			return mono_get_corlib();
+		for (const char* name : { "System.Numerics", "System.Numerics.Vectors" }) {
+			MonoImageOpenStatus status{};
+			MonoAssembly* assembly = mono_assembly_load_with_partial_name(name, &status);
+			if (assembly && mono_class_from_name(mono_assembly_get_image(assembly), "System.Numerics", "Vector2"))
+				return mono_assembly_get_image(assembly);
+		}
+		return nullptr;
+	}
+
+	bool ParseSize(std::string_view str, uint64_t& size) {
+		uint64_t value = 0;
+		auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+		if (ec != std::errc{} || value == 0)
+			return false;
+
+		std::string_view suffix(ptr, static_cast<size_t>(str.data() + str.size() - ptr));
+		int shift = 0;
+		if (suffix == "k" || suffix == "K") {
+			shift = 10;
+		} else if (suffix == "m" || suffix == "M") {
+			shift = 20;
+		} else if (suffix == "g" || suffix == "G") {
+			shift = 30;
+		} else if (!suffix.empty()) {
+			return false;
+		}
+		if (value > (std::numeric_limits<uint64_t>::max() >> shift))
+			return false;
+
+		size = value << shift;
+		return true;
+	}
+
+	/// Plain positive integer without suffix, like the milliseconds of "pause:<ms>".
+	bool ParseCount(std::string_view str, uint64_t& count) {
+		uint64_t value = 0;
+		auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+		if (ec != std::errc{} || ptr != str.data() + str.size() || value == 0)
+			return false;
+
+		count = value;
+		return true;
+	}
+
+	/// Fills unset values from the preset and validates the result, returns an error message on failure.
+	std::string ResolveRuntimeSettings(RuntimeSettings& runtime) {
+		auto setDefault = [](std::string& value, std::string_view preset) {
+			if (value.empty()) {
+				value = preset;
+			}
+		};
+
+		if (runtime.preset == "latency") {
+			// Small nursery and concurrent marking keep both minor and major pauses short
+			setDefault(runtime.nurserySize, "4m");
+			setDefault(runtime.majorMode, "pause");
+			if (!runtime.concurrentMark.has_value()) {
+				runtime.concurrentMark = true;
+			}
+		} else if (runtime.preset == "throughput") {
+			setDefault(runtime.optimize, "all");
+			setDefault(runtime.nurserySize, "64m");
+			setDefault(runtime.majorMode, "throughput");
+			if (!runtime.concurrentMark.has_value()) {
+				runtime.concurrentMark = false;
+			}
+		} else if (!runtime.preset.empty()) {
+			return std::format("Unknown runtime preset '{}', expected 'latency' or 'throughput'", runtime.preset);
+		}
+
+		uint64_t size = 0;
+		if (!runtime.nurserySize.empty() && (!ParseSize(runtime.nurserySize, size) || (size & (size - 1)) != 0))
+			return std::format("Invalid nursery size '{}', expected power of two like '4m'", runtime.nurserySize);
+
+		if (!runtime.softHeapLimit.empty() && !ParseSize(runtime.softHeapLimit, size))
+			return std::format("Invalid soft heap limit '{}', expected size like '512m'", runtime.softHeapLimit);
+
+		if (!runtime.majorMode.empty()) {
+			std::string_view mode(runtime.majorMode);
+			if (mode.starts_with("pause:")) {
+				uint64_t pauseMs = 0;
+				if (!ParseCount(mode.substr(6), pauseMs))
+					return std::format("Invalid max pause in major mode '{}', expected milliseconds like 'pause:10'", runtime.majorMode);
+			} else if (mode != "balanced" && mode != "throughput" && mode != "pause") {
+				return std::format("Unknown major mode '{}', expected 'balanced', 'throughput' or 'pause[:ms]'", runtime.majorMode);
+			}
+		}
+
+		for (char c : runtime.optimize) {
+			if (!std::isalnum(static_cast<unsigned char>(c)) && c != ',' && c != '-' && c != '_')
+				return std::format("Invalid JIT optimize flags '{}'", runtime.optimize);
+		}
+
+		return {};
+	}
+
+	std::string BuildGcParams(const RuntimeSettings& runtime) {
+		std::string params;
+		auto append = [&params](std::string_view key, std::string_view value) {
+			if (value.empty())
+				return;
+			if (!params.empty()) {
+				params += ',';
+			}
+			std::format_to(std::back_inserter(params), "{}={}", key, value);
+		};
+
+		append("nursery-size", runtime.nurserySize);
+		if (runtime.concurrentMark.has_value()) {
+			append("major", *runtime.concurrentMark ? "marksweep-conc" : "marksweep");
+		}
+		append("mode", runtime.majorMode);
+		append("soft-heap-limit", runtime.softHeapLimit);
+		return params;
+	}
+
+	// Bumped on every runtime start and shutdown, attachments of older generations are stale
+	std::atomic<uint32_t> s_runtimeGeneration{ 0 };
+
+	struct ThreadAttachment {
+		uint32_t generation{ 0 };
+		MonoThread* thread{ nullptr };
+
+		~ThreadAttachment() {
+			if (thread && generation == s_runtimeGeneration.load(std::memory_order_acquire)) {
+				mono_thread_detach(thread);
+			}
+		}
+	};
+
+	thread_local uint32_t t_attachedGeneration{ 0 };
+	thread_local ThreadAttachment t_attachment;
+
+	std::atomic<bool> s_debuggingRequested{ false };
+
+	void OnDebugSignal(int /*signal*/) {
+		// Only async-signal-safe work here, activation happens on the next call into the module
+		s_debuggingRequested.store(true, std::memory_order_relaxed);
 	}
 }
 
@@ -374,30 +604,85 @@ InitResult CSharpLanguageModule::Initialize(std::weak_ptr<IPlugifyProvider> prov
 		return ErrorData{ std::format("File '" SETTINGS_FILE "' has JSON parsing error: {}", glz::format_error(settings.error(), json)) };
 	_settings = std::move(*settings);
 
+	std::string runtimeError = ResolveRuntimeSettings(_settings.runtime);
+	if (!runtimeError.empty())
+		return ErrorData{ std::format("File '" SETTINGS_FILE "' has invalid runtime settings: {}", runtimeError) };
+
+	if (!_settings.startupTrace.empty()) {
+		fs::path tracePath(_settings.startupTrace);
+		if (tracePath.is_relative()) {
+			tracePath = fs::path(module.GetBaseDir()) / tracePath;
+		}
+		_startupProfiler.Enable(std::move(tracePath));
+	}
+
+	if (!_settings.samplingOutput.empty()) {
+		fs::path outputPath(_settings.samplingOutput);
+		if (outputPath.is_relative()) {
+			_settings.samplingOutput = (fs::path(module.GetBaseDir()) / outputPath).string();
+		}
+	}
+
+	if (!_settings.gcTrace.empty()) {
+		fs::path tracePath(_settings.gcTrace);
+		if (tracePath.is_relative()) {
+			_settings.gcTrace = (fs::path(module.GetBaseDir()) / tracePath).string();
+		}
+	}
+
+	if (!_settings.callTrace.empty()) {
+		fs::path tracePath(_settings.callTrace);
+		if (tracePath.is_relative()) {
+			_settings.callTrace = (fs::path(module.GetBaseDir()) / tracePath).string();
+		}
+	}
+
+	ScopedPhase initPhase(_startupProfiler, "Initialize", "module");
+
 	fs::path monoPath(module.GetBaseDir());
 	monoPath /= "mono";
 
 	auto configPath = module.FindResource(MONOLM_NSTR("configs/mono_config"));
 
+	_rt = std::make_shared<asmjit::JitRuntime>();
+
+	// Opened before the runtime starts, so the map also names code Mono generates during startup
+	if (_settings.perfMap) {
+#if MONOLM_PLATFORM_WINDOWS
+		_provider->Log(LOG_PREFIX "Perf map is not supported on Windows", Severity::Warning);
+#else
+		if (_perfMap.Open(_rt)) {
+			_provider->Log(std::format(LOG_PREFIX "Writing perf map to: {}", _perfMap.GetPath().string()), Severity::Info);
+		} else {
+			int error = errno;
+			_provider->Log(std::format(LOG_PREFIX "Failed to create perf map '{}': {}", _perfMap.GetPath().string(), std::generic_category().message(error)), Severity::Warning);
+		}
+#endif
+	}
+
 	if (!InitMono(monoPath, configPath))
 		return ErrorData{ "Initialization of mono failed" };
 
 	Glue::RegisterFunctions();
 
-	_rt = std::make_shared<asmjit::JitRuntime>();
+	{
+		ScopedPhase phase(_startupProfiler, "CreateAppDomain", "module");
 
-	// Create an app domain
-	char appName[] = "PlugifyMonoRuntime";
-	MonoDomain* appDomain = mono_domain_create_appdomain(appName, nullptr);
-	if (!appDomain)
-		return ErrorData{ "Initialization of PlugifyMonoRuntime domain failed" };
+		// Create an app domain
+		char appName[] = "PlugifyMonoRuntime";
+		MonoDomain* appDomain = mono_domain_create_appdomain(appName, nullptr);
+		if (!appDomain)
+			return ErrorData{ "Initialization of PlugifyMonoRuntime domain failed" };
 
-	mono_domain_set(appDomain, true);
-	_appDomain = std::unique_ptr<MonoDomain, AppDomainDeleter>(appDomain);
+		mono_domain_set(appDomain, true);
+		_appDomain = std::unique_ptr<MonoDomain, AppDomainDeleter>(appDomain);
+	}
 
 	std::vector<std::string> assemblyErrors;
 
 	{
+		ScopedPhase phase(_startupProfiler, "LoadCoreAssembly", "module");
+
 		fs::path assemblyPath(module.GetBaseDir());
 		assemblyPath /= "api/Plugify.dll";
 
@@ -412,7 +697,13 @@ InitResult CSharpLanguageModule::Initialize(std::weak_ptr<IPlugifyProvider> prov
 		}
 	}
 
+	if (_heapSnapshot.IsEnabled()) {
+		_heapSnapshot.AddImage(_core.image, "[core]");
+	}
+
 	{
+		ScopedPhase phase(_startupProfiler, "LoadCoreClass", "module");
+
 		_plugin = LoadCoreClass(assemblyErrors, _core.image, "Plugin", 9);
 
 		if (!assemblyErrors.empty()) {
@@ -424,10 +715,79 @@ InitResult CSharpLanguageModule::Initialize(std::weak_ptr<IPlugifyProvider> prov
 		}
 	}
 
+	{
+		ScopedPhase phase(_startupProfiler, "LoadLifecycle", "module");
+
+		MonoClass* lifecycle = mono_class_from_name(_core.image, "Plugify", "Lifecycle");
+		if (lifecycle) {
+			_lifecycle.registerPlugin = LoadCoreThunk<InstanceThunk>(assemblyErrors, lifecycle, "Lifecycle", "Register", 1);
+			_lifecycle.unregisterPlugin = LoadCoreThunk<InstanceThunk>(assemblyErrors, lifecycle, "Lifecycle", "Unregister", 1);
+			_lifecycle.update = LoadCoreThunk<TickThunk>(assemblyErrors, lifecycle, "Lifecycle", "Update", 1);
+			_lifecycle.fixedUpdate = LoadCoreThunk<TickThunk>(assemblyErrors, lifecycle, "Lifecycle", "FixedUpdate", 1);
+			_lifecycle.resetAbort = LoadCoreThunk<StaticThunk>(assemblyErrors, lifecycle, "Lifecycle", "ResetAbort", 0);
+		} else {
+			assemblyErrors.emplace_back("Lifecycle");
+		}
+
+		// Optional, exports fall back to the generic call path without it
+		if (MonoClass* exports = mono_class_from_name(_core.image, "Plugify", "NativeExports")) {
+			_createEntryPoint = mono_class_get_method_from_name(exports, "CreateEntryPoint", 2);
+		}
+
+		// Signature classification compares class identities, the cache starts with the classes of the fixed types
+		if (MonoClass* delegate = mono_class_from_name(mono_get_corlib(), "System", "Delegate")) {
+			_classTypes.emplace(delegate, ValueType::Function);
+		}
+		if (MonoImage* numerics = FindNumericsImage()) {
+			const std::pair<const char*, ValueType> numericsTypes[] = {
+				{ "Vector2", ValueType::Vector2 },
+				{ "Vector3", ValueType::Vector3 },
+				{ "Vector4", ValueType::Vector4 },
+				{ "Matrix4x4", ValueType::Matrix4x4 },
+			};
+			for (const auto& [name, type] : numericsTypes) {
+				if (MonoClass* klass = mono_class_from_name(numerics, "System.Numerics", name)) {
+					_classTypes.emplace(klass, type);
+				}
+			}
+		}
+
+		if (!assemblyErrors.empty()) {
+			std::string methods("Not found: " + assemblyErrors[0]);
+			for (auto it = std::next(assemblyErrors.begin()); it != assemblyErrors.end(); ++it) {
+				std::format_to(std::back_inserter(methods), ", {}", *it);
+			}
+			return ErrorData{ methods };
+		}
+	}
+
 	_provider->Log("Loaded dependency assemblies and classes", Severity::Debug);
 
 	_callbackReferenceQueue = std::unique_ptr<MonoReferenceQueue>(mono_gc_reference_queue_new(CallbackRefQueueCallback));
 	_callReferenceQueue = std::unique_ptr<MonoReferenceQueue>(mono_gc_reference_queue_new(CallRefQueueCallback));
+	_functionReferenceQueue = std::unique_ptr<MonoReferenceQueue>(mono_gc_reference_queue_new(OnCachedDelegateCollected));
+	_thunkPool.Init(_rt, &DelegateCall, &_perfMap);
+	_scheduler.Init(_appDomain.get(), _settings.workerThreads, &HandleException);
+	_callStats.Enable(_settings.callStats);
+	_allocStats.Enable(_settings.allocStats);
+
+	if (_settings.timeAccounting) {
+		_timeAccounting.Enable(_settings.timeBudget, _settings.interruptRunaway, [provider = _provider](const std::string& message) {
+			provider->Log(std::format(LOG_PREFIX "{}", message), Severity::Warning);
+		});
+	}
+
+	if (!_settings.callTrace.empty()) {
+		if (_callRecorder.Open(_settings.callTrace)) {
+			_provider->Log(std::format(LOG_PREFIX "Capturing export calls to: {}", _settings.callTrace), Severity::Info);
+		} else {
+			_provider->Log(std::format(LOG_PREFIX "Failed to create call trace: {}", _settings.callTrace), Severity::Warning);
+		}
+	}
+
+	if (_samplingProfiler.Start()) {
+		_provider->Log(std::format(LOG_PREFIX "Sampling managed stacks at {} Hz", _settings.samplingFrequency), Severity::Info);
+	}
 
 	_provider->Log(LOG_PREFIX "Inited!", Severity::Debug);
 
@@ -437,17 +797,81 @@ InitResult CSharpLanguageModule::Initialize(std::weak_ptr<IPlugifyProvider> prov
 void CSharpLanguageModule::Shutdown() {
 	_provider->Log(LOG_PREFIX "Shutting down Mono runtime", Severity::Debug);
 
+	// Startup never completed, e.g. a plugin failed to start before the first tick
+	FlushStartupTrace();
+
+	_jitWarmup.Stop();
+	_scheduler.Shutdown();
+
+	if (_callStats.IsEnabled()) {
+		_provider->Log(std::format(LOG_PREFIX "Call statistics:\n{}", _callStats.Report()), Severity::Info);
+		_callStats.Enable(false);
+		_callStats.Reset();
+	}
+
+	if (_allocStats.IsEnabled()) {
+		_provider->Log(std::format(LOG_PREFIX "Marshalling allocations:\n{}", _allocStats.Report()), Severity::Info);
+		_allocStats.Enable(false);
+		_allocStats.Reset();
+	}
+
+	if (_samplingProfiler.IsEnabled()) {
+		_samplingProfiler.Stop();
+		if (!_settings.samplingOutput.empty()) {
+			fs::path outputPath(_settings.samplingOutput);
+			if (_samplingProfiler.Write(outputPath)) {
+				_provider->Log(std::format(LOG_PREFIX "Wrote {} managed stack samples to: {}", _samplingProfiler.GetSampleCount(), outputPath.string()), Severity::Info);
+			} else {
+				_provider->Log(std::format(LOG_PREFIX "Failed to write managed stack samples: {}", outputPath.string()), Severity::Warning);
+			}
+		}
+		if (uint64_t dropped = _samplingProfiler.GetDroppedCount()) {
+			_provider->Log(std::format(LOG_PREFIX "Dropped {} managed stack samples, the sampling frequency is too high", dropped), Severity::Warning);
+		}
+	}
+
+	if (_gcMonitor.IsEnabled()) {
+		_provider->Log(std::format(LOG_PREFIX "Garbage collector: {}", _gcMonitor.Report()), Severity::Info);
+		if (!_settings.gcTrace.empty()) {
+			if (_gcMonitor.WriteTrace(_settings.gcTrace)) {
+				_provider->Log(std::format(LOG_PREFIX "GC trace written to: {}", _settings.gcTrace), Severity::Info);
+			} else {
+				_provider->Log(std::format(LOG_PREFIX "Failed to write GC trace: {}", _settings.gcTrace), Severity::Warning);
+			}
+		}
+	}
+
+	if (_timeAccounting.IsEnabled()) {
+		_provider->Log(std::format(LOG_PREFIX "Managed time per plugin:\n{}", _timeAccounting.Report()), Severity::Info);
+		_timeAccounting.Disable();
+	}
+
+	if (_callRecorder.IsOpen()) {
+		_provider->Log(std::format(LOG_PREFIX "Captured {} export calls to: {}", _callRecorder.GetCallCount(), _callRecorder.GetPath().string()), Severity::Info);
+		_callRecorder.Close();
+	}
+
 	_callbackReferenceQueue.reset();
 	_callReferenceQueue.reset();
-	_cachedFunctions.clear();
-	_cachedDelegates.clear();
+	_functionReferenceQueue.reset();
+	_thunkPool.Shutdown();
+	_cachedFunctions.EraseIf([](int32_t /*identity*/, const std::vector<CachedFunction>& functions) {
+		for (const auto& function : functions) {
+			mono_gchandle_free(function.handle);
+		}
+		return true;
+	});
+	_cachedDelegates.Clear();
 	_importMethods.clear();
+	_trackedImports.clear();
 	_exportMethods.clear();
-	_functions.clear();
+	_functions.Clear();
+	_classTypes.clear();
 	_scripts.clear();
 	_rt.reset();
 
 	ShutdownMono();
+	_perfMap.Close();
 	_provider.reset();
 }
 
@@ -456,44 +880,94 @@ void CSharpLanguageModule::Shutdown() {
 }*/
 
 bool CSharpLanguageModule::InitMono(const fs::path& monoPath, std::optional<fs::path> configPath) {
+	ScopedPhase initPhase(_startupProfiler, "InitMono", "module");
+
 	_provider->Log(std::format("Loading mono from: {}", monoPath.string()), Severity::Debug);
 
-	mono_trace_set_print_handler(OnPrintCallback);
-	mono_trace_set_printerr_handler(OnPrintErrorCallback);
-	mono_trace_set_log_handler(OnLogCallback, nullptr);
+	{
+		ScopedPhase phase(_startupProfiler, "TraceSetup", "module");
+
+		mono_trace_set_print_handler(OnPrintCallback);
+		mono_trace_set_printerr_handler(OnPrintErrorCallback);
+		mono_trace_set_log_handler(OnLogCallback, nullptr);
 
-	std::error_code error;
-	std::string monoEnvPath(Utils::GetEnvVariable("MONO_PATH"));
-	if (fs::exists(monoPath, error)) {
-		for (const auto& entry : fs::directory_iterator(monoPath, error)) {
-			if (entry.is_directory(error)) {
-				fs::path path(entry.path());
-				path.make_preferred();
-				std::format_to(std::back_inserter(monoEnvPath), PATH_SEPARATOR "{}", path.string());
+		std::error_code error;
+		std::string monoEnvPath(Utils::GetEnvVariable("MONO_PATH"));
+		if (fs::exists(monoPath, error)) {
+			for (const auto& entry : fs::directory_iterator(monoPath, error)) {
+				if (entry.is_directory(error)) {
+					fs::path path(entry.path());
+					path.make_preferred();
+					std::format_to(std::back_inserter(monoEnvPath), PATH_SEPARATOR "{}", path.string());
+				}
 			}
 		}
+		//SetEnvVariable("MONO_PATH", monoEnvPath.c_str());
+		mono_set_assemblies_path(monoEnvPath.c_str());
 	}
-	//SetEnvVariable("MONO_PATH", monoEnvPath.c_str());
-	mono_set_assemblies_path(monoEnvPath.c_str());
 
 	// Seems we can write custom assembly loader here
 	//mono_install_assembly_preload_hook(OnMonoAssemblyPreloadHook, nullptr);
 
+	std::vector<char*> options;
+
+	std::string optimizeOption;
+	if (!_settings.runtime.optimize.empty()) {
+		optimizeOption = std::format("--optimize={}", _settings.runtime.optimize);
+		options.push_back(optimizeOption.data());
+	}
+
 	if (_settings.enableDebugging) {
-		if (!_settings.options.empty()) {
-			std::vector<char*> options;
-			options.reserve(_settings.options.size());
-			for (auto& opt: _settings.options) {
-				if (std::find(options.begin(), options.end(), opt.data()) == options.end()) {
-					if (opt.starts_with("--debugger")) {
-						_provider->Log(std::format(LOG_PREFIX "Mono debugger: {}", opt), Severity::Info);
-					}
-					options.push_back(opt.data());
+		options.reserve(options.size() + _settings.options.size());
+		for (auto& opt: _settings.options) {
+			if (std::find(options.begin(), options.end(), opt.data()) == options.end()) {
+				if (_settings.lazyDebugging && opt == "--soft-breakpoints") {
+					// Soft breakpoints instrument every JIT-compiled method, so they are never enabled in standby
+					_provider->Log(LOG_PREFIX "Mono debugger: '--soft-breakpoints' ignored in lazy debugging mode", Severity::Info);
+					continue;
+				}
+				if (opt.starts_with("--debugger")) {
+					_provider->Log(std::format(LOG_PREFIX "Mono debugger: {}", opt), Severity::Info);
 				}
+				options.push_back(opt.data());
 			}
-			mono_jit_parse_options(static_cast<int>(options.size()), options.data());
 		}
+	}
+
+	if (!options.empty()) {
+		mono_jit_parse_options(static_cast<int>(options.size()), options.data());
+	}
+
+	{
+		std::string gcParams(BuildGcParams(_settings.runtime));
+		if (!gcParams.empty()) {
+			// Parameters from the environment come last, so they still override the settings file
+			std::string envParams(Utils::GetEnvVariable("MONO_GC_PARAMS"));
+			if (!envParams.empty()) {
+				std::format_to(std::back_inserter(gcParams), ",{}", envParams);
+			}
+			Utils::SetEnvVariable("MONO_GC_PARAMS", gcParams.c_str());
+		}
+
+		const auto& runtime = _settings.runtime;
+		_provider->Log(std::format(LOG_PREFIX "Mono runtime: preset '{}', optimize '{}', MONO_GC_PARAMS '{}'",
+			runtime.preset.empty() ? "none" : runtime.preset, runtime.optimize, Utils::GetEnvVariable("MONO_GC_PARAMS")), Severity::Info);
+	}
+
+	if (_settings.enableDebugging) {
 		mono_debug_init(MONO_DEBUG_FORMAT_MONO);
+
+		if (_settings.lazyDebugging) {
+			_provider->Log(LOG_PREFIX "Mono debugger: symbols are loaded on demand", Severity::Info);
+#if !MONOLM_PLATFORM_WINDOWS
+			if (_settings.debugSignal > 0) {
+				std::signal(_settings.debugSignal, OnDebugSignal);
+				_provider->Log(std::format(LOG_PREFIX "Mono debugger: send signal {} to activate debugging", _settings.debugSignal), Severity::Info);
+			}
+#endif
+		} else {
+			_debuggingActive = true;
+		}
 	}
 
 	if (!_settings.level.empty())
@@ -501,9 +975,29 @@ bool CSharpLanguageModule::InitMono(const fs::path& monoPath, std::optional<fs::
 	if (!_settings.mask.empty())
 		mono_trace_set_mask_string(_settings.mask.c_str());
 
-	mono_config_parse(configPath.has_value() ? configPath->string().c_str() : nullptr);
+	{
+		ScopedPhase phase(_startupProfiler, "ConfigParse", "module");
+		mono_config_parse(configPath.has_value() ? configPath->string().c_str() : nullptr);
+	}
+
+	// Sampling can only be enabled before the runtime starts
+	if (_settings.samplingFrequency != 0) {
+		_samplingProfiler.Enable(_settings.samplingFrequency);
+	}
+
+	if (_settings.gcMonitor) {
+		_gcMonitor.Enable();
+	}
 
-	MonoDomain* rootDomain = mono_jit_init("PlugifyJITRuntime");
+	if (_settings.heapSnapshot) {
+		_heapSnapshot.Enable();
+	}
+
+	MonoDomain* rootDomain;
+	{
+		ScopedPhase phase(_startupProfiler, "JitInit", "module");
+		rootDomain = mono_jit_init("PlugifyJITRuntime");
+	}
 	if (!rootDomain)
 		return false;
 
@@ -515,6 +1009,12 @@ bool CSharpLanguageModule::InitMono(const fs::path& monoPath, std::optional<fs::
 
 	mono_thread_set_main(mono_thread_current());
 
+	s_runtimeGeneration.fetch_add(1, std::memory_order_acq_rel);
+
+	if (_settings.jitWarmup) {
+		_jitWarmup.Enable();
+	}
+
 	mono_install_unhandled_exception_hook(HandleException, nullptr);
 	//mono_set_crash_chaining(true);
 
@@ -526,12 +1026,24 @@ bool CSharpLanguageModule::InitMono(const fs::path& monoPath, std::optional<fs::
 }
 
 void CSharpLanguageModule::ShutdownMono() {
+#if !MONOLM_PLATFORM_WINDOWS
+	if (_settings.lazyDebugging && _settings.debugSignal > 0) {
+		std::signal(_settings.debugSignal, SIG_DFL);
+	}
+#endif
+	_pendingSymbols.clear();
+	_debuggingActive = false;
+
+	s_runtimeGeneration.fetch_add(1, std::memory_order_acq_rel);
+
 	mono_domain_set(mono_get_root_domain(), false);
 
 	_appDomain.reset();
 	_rootDomain.reset();
 
 	_core = AssemblyInfo{};
+	_lifecycle = LifecycleInfo{};
+	_createEntryPoint = nullptr;
 
 	_provider->Log(LOG_PREFIX "Shut down Mono runtime", Severity::Debug);
 }
@@ -550,6 +1062,9 @@ void* CSharpLanguageModule::MonoArrayToArg(MonoArray* source, ArgumentList& args
 		MonoArrayToVector(source, *dest);
 	}
 	args.push_back(dest);
+	if (g_monolm._allocStats.IsEnabled()) {
+		g_monolm._allocStats.Record(AllocKind::Native, NativeValueType<std::vector<T>>(), NativeSizeOf(*dest));
+	}
 	return dest;
 }
 
@@ -569,6 +1084,9 @@ void* CSharpLanguageModule::MonoStringToArg(MonoString* source, ArgumentList& ar
 		dest = new plg::string();
 	}
 	args.push_back(dest);
+	if (g_monolm._allocStats.IsEnabled()) {
+		g_monolm._allocStats.Record(AllocKind::Native, ValueType::String, NativeSizeOf(*dest));
+	}
 	return dest;
 }
 
@@ -586,55 +1104,176 @@ void* CSharpLanguageModule::MonoDelegateToArg(MonoDelegate* source, MethodRef me
 		const void* raw = mono_lookup_internal_call_full(source->method, 0, nullptr, nullptr);
 		if (raw != nullptr) {
 			void* addr = const_cast<void*>(raw);
-			auto it = _functions.find(addr);
-			if (it != _functions.end()) {
-				return std::get<Function>(*it).first.GetUserData();
+			void* userData = nullptr;
+			if (_functions.Find(addr, [&userData](const Function& function) { userData = function.first.GetUserData(); })) {
+				return userData;
 			} else {
 				return addr;
 			}
 		}
 	}
 
-	uint32_t ref = mono_gchandle_new_weakref(reinterpret_cast<MonoObject*>(source), 0);
-
-	auto it = _cachedFunctions.find(ref);
-	if (it != _cachedFunctions.end()) {
-		return std::get<void*>(*it);
+	if (!IsMethodPrimitive(method)) {
+		// Thunks are pooled per signature and bound to the delegate through a weak handle
+		std::string error;
+		void* methodAddr = _thunkPool.Acquire(reinterpret_cast<MonoObject*>(source), method, error);
+		if (!methodAddr) {
+			_provider->Log(std::format(LOG_PREFIX "{}: {}", method.GetFunctionName(), error), Severity::Error);
+		}
+		return methodAddr;
 	}
 
-	CleanupFunctionCache();
+	// Keyed by identity like the thunk pool, entries are dropped by the reference queue once the delegate is collected
+	auto* object = reinterpret_cast<MonoObject*>(source);
+	int32_t identity = mono_object_hash(object);
 
-	void* methodAddr;
-
-	if (IsMethodPrimitive(method)) {
-		methodAddr = mono_delegate_to_ftnptr(source);
-	} else {
-		auto* callback = new plugify::JitCallback(_rt);
-		methodAddr = callback->GetJitFunc(method, &DelegateCall, source);
+	auto find = [object](const std::vector<CachedFunction>& functions) -> void* {
+		for (const auto& [handle, addr] : functions) {
+			if (mono_gchandle_get_target(handle) == object)
+				return addr;
+		}
+		return nullptr;
+	};
 
-		// Attach dtor event to object
-		mono_gc_reference_queue_add(_callbackReferenceQueue.get(), reinterpret_cast<MonoObject*>(source), reinterpret_cast<void*>(callback));
+	void* cachedAddr = nullptr;
+	if (_cachedFunctions.Find(identity, [&](const std::vector<CachedFunction>& functions) { cachedAddr = find(functions); }) && cachedAddr) {
+		return cachedAddr;
 	}
 
-	_cachedFunctions.emplace(ref, methodAddr);
+	void* methodAddr = mono_delegate_to_ftnptr(source);
+
+	bool inserted = false;
+	uint32_t handle = 0;
+	_cachedFunctions.Upsert(identity, [&](std::vector<CachedFunction>& functions) {
+		// Another thread may have converted the same delegate in the meantime
+		if (find(functions))
+			return;
+		handle = mono_gchandle_new_weakref(object, 0);
+		functions.push_back({ handle, methodAddr });
+		inserted = true;
+	});
+
+	if (inserted) {
+		mono_gc_reference_queue_add(_functionReferenceQueue.get(), object, new CachedFunctionLease{ identity, handle });
+	}
 
 	return methodAddr;
 }
 
-void CSharpLanguageModule::CleanupFunctionCache() {
-	for (auto it = _cachedFunctions.begin(); it != _cachedFunctions.end();) {
-		if (mono_gchandle_get_target(it->first) == nullptr) {
-			it = _cachedFunctions.erase(it);
-		} else {
-			++it;
+void CSharpLanguageModule::OnCachedDelegateCollected(void* userData) {
+	auto* lease = static_cast<CachedFunctionLease*>(userData);
+	g_monolm._cachedFunctions.UpdateOrErase(lease->identity, [lease](std::vector<CachedFunction>& functions) {
+		auto it = std::find_if(functions.begin(), functions.end(), [lease](const CachedFunction& function) {
+			return function.handle == lease->handle;
+		});
+		if (it != functions.end()) {
+			mono_gchandle_free(it->handle);
+			functions.erase(it);
+		}
+		return functions.empty();
+	});
+	delete lease;
+}
+
+void CSharpLanguageModule::LoadSymbols(MonoImage* image, fs::path pdbPath) {
+	if (!_debuggingActive) {
+		std::lock_guard lock(_debugMutex);
+		if (!_debuggingActive) {
+			_pendingSymbols.emplace_back(image, std::move(pdbPath));
+			return;
 		}
 	}
+
+	auto bytes = Utils::ReadBytes<mono_byte>(pdbPath);
+	if (bytes.empty()) {
+		_provider->Log(std::format(LOG_PREFIX "Symbols not found: {}", pdbPath.string()), Severity::Debug);
+		return;
+	}
+	mono_debug_open_image_from_memory(image, bytes.data(), static_cast<int>(bytes.size()));
+}
+
+bool CSharpLanguageModule::ActivateDebugging() {
+	s_debuggingRequested.store(false, std::memory_order_relaxed);
+
+	if (!_settings.enableDebugging)
+		return false;
+
+	std::vector<PendingSymbols> pending;
+	{
+		std::lock_guard lock(_debugMutex);
+		if (_debuggingActive)
+			return true;
+		pending = std::move(_pendingSymbols);
+		_pendingSymbols.clear();
+		_debuggingActive = true;
+	}
+
+	for (auto& [image, pdbPath] : pending) {
+		LoadSymbols(image, std::move(pdbPath));
+	}
+
+	_provider->Log(std::format(LOG_PREFIX "Mono debugger: activated, loaded symbols for {} assemblies", pending.size()), Severity::Info);
+	return true;
+}
+
+void CSharpLanguageModule::AttachCurrentThread() {
+	uint32_t generation = s_runtimeGeneration.load(std::memory_order_acquire);
+	if (t_attachedGeneration == generation)
+		return;
+
+	t_attachedGeneration = generation;
+
+	// Threads without a domain are foreign to the runtime, e.g. engine job workers
+	bool foreign = mono_domain_get() == nullptr;
+	MonoThread* thread = mono_thread_attach(_appDomain.get());
+
+	if (foreign && _settings.detachThreadsOnExit) {
+		t_attachment.generation = generation;
+		t_attachment.thread = thread;
+	}
+}
+
+void CSharpLanguageModule::PollDebuggingRequest() {
+	if (s_debuggingRequested.load(std::memory_order_relaxed)) {
+		ActivateDebugging();
+	}
 }
 
 // Call from C# to C++
 void CSharpLanguageModule::ExternalCall(MethodRef method, MemAddr data, const JitCallback::Parameters* p, uint8_t count, const JitCallback::ReturnValue* ret) {
-	const auto& func = data.RCast<JitCall::CallingFunc>();
-	
+	ExternalCallImpl(method, data.RCast<JitCall::CallingFunc>(), nullptr, p, count, ret);
+}
+
+void CSharpLanguageModule::ExternalCallTracked(MethodRef method, MemAddr data, const JitCallback::Parameters* p, uint8_t count, const JitCallback::ReturnValue* ret) {
+	auto* import = data.RCast<ImportMethod*>();
+	ExternalCallImpl(method, import->func, import, p, count, ret);
+}
+
+void CSharpLanguageModule::InvokeNative(MethodRef method, JitCall::CallingFunc func, ImportMethod* import, const uint64_t* params, const JitCallback::ReturnValue* ret) {
+	if (import->gcSafe.load(std::memory_order_relaxed)) {
+		// Arguments are native copies at this point, so the GC is free to run until the call returns
+		void* stackdata[2]{};
+		void* cookie = mono_threads_enter_gc_safe_region(stackdata);
+		func(params, reinterpret_cast<const JitCall::Return*>(ret));
+		mono_threads_exit_gc_safe_region(cookie, stackdata);
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	func(params, reinterpret_cast<const JitCall::Return*>(ret));
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	uint32_t threshold = g_monolm._settings.gcSafeThresholdUs;
+	if (threshold != 0 && import->gcSafeCapable && elapsed.count() >= threshold && !import->gcSafe.exchange(true)) {
+		g_monolm._provider->Log(std::format(LOG_PREFIX "Method '{}' took {}us, further calls run in GC safe mode", method.GetFunctionName(), elapsed.count()), Severity::Info);
+	}
+}
+
+void CSharpLanguageModule::ExternalCallImpl(MethodRef method, JitCall::CallingFunc func, ImportMethod* import, const JitCallback::Parameters* p, uint8_t count, const JitCallback::ReturnValue* ret) {
+	const void* site = import ? static_cast<const void*>(import) : reinterpret_cast<const void*>(func);
+	CallTimer timer(g_monolm._callStats, site, CallKind::Import, method);
+	AllocStats::Scope allocScope(g_monolm._allocStats, site, CallKind::Import, method);
+
 	PropertyRef retProp = method.GetReturnType();
 	ValueType retType = retProp.GetType();
 	std::span<const PropertyRef> paramProps = method.GetParamTypes();
@@ -952,7 +1591,13 @@ void CSharpLanguageModule::ExternalCall(MethodRef method, MemAddr data, const Ji
 		hasRefs |= param.IsReference();
 	}
 
-	func(parameters.GetDataPtr(), reinterpret_cast<const JitCall::Return*>(ret));
+	timer.BeginCallee();
+	if (import) {
+		InvokeNative(method, func, import, parameters.GetDataPtr(), ret);
+	} else {
+		func(parameters.GetDataPtr(), reinterpret_cast<const JitCall::Return*>(ret));
+	}
+	timer.EndCallee();
 
 	switch (retType) {
 		case ValueType::Void:
@@ -1258,7 +1903,18 @@ void CSharpLanguageModule::DeleteReturn(const ArgumentList& args, size_t& i, Val
 
 // Call from C++ to C#
 void CSharpLanguageModule::InternalCall(MethodRef method, MemAddr data, const JitCallback::Parameters* p, uint8_t count, const JitCallback::ReturnValue* ret) {
-	const auto& [monoMethod, monoObject] = *data.RCast<ExportMethod*>();
+	auto* exportMethod = data.RCast<ExportMethod*>();
+	MonoMethod* monoMethod = exportMethod->method;
+	MonoObject* monoObject = exportMethod->instance;
+
+	CallTimer timer(g_monolm._callStats, exportMethod, CallKind::Export, method);
+	AllocStats::Scope allocScope(g_monolm._allocStats, exportMethod, CallKind::Export, method);
+
+	g_monolm.AttachCurrentThread();
+	g_monolm.PollDebuggingRequest();
+
+	TimeAccounting::Scope timeScope(g_monolm._timeAccounting, exportMethod->account, TimeKind::Export, method.GetFunctionName(), true);
+	CallRecorder::Scope traceScope(g_monolm._callRecorder, exportMethod->traceId, method, p, count);
 
 	PropertyRef retProp = method.GetReturnType();
 	ValueType retType = retProp.GetType();
@@ -1274,8 +1930,16 @@ void CSharpLanguageModule::InternalCall(MethodRef method, MemAddr data, const Ji
 	SetParams(paramProps, p, count, hasRet, hasRefs, args);
 
 	MonoObject* exception = nullptr;
+	timer.BeginCallee();
 	MonoObject* result = mono_runtime_invoke(monoMethod, monoObject, args.data(), &exception);
+	timer.EndCallee();
+	if (timeScope.Returned()) {
+		// Aborted by the runaway call watchdog, an abort still pending would hit the next managed call of this thread
+		MonoException* resetException = nullptr;
+		g_monolm._lifecycle.resetAbort(&resetException);
+	}
 	if (exception) {
+		timer.SetException();
 		HandleException(exception, nullptr);
 		ret->SetReturn(uintptr_t{});
 		return;
@@ -1288,7 +1952,36 @@ void CSharpLanguageModule::InternalCall(MethodRef method, MemAddr data, const Ji
 
 // Call from C++ to C#
 void CSharpLanguageModule::DelegateCall(MethodRef method, MemAddr data, const JitCallback::Parameters* p, uint8_t count, const JitCallback::ReturnValue* ret) {
-	auto* monoDelegate = data.RCast<MonoObject*>();
+	auto* slot = data.RCast<DelegateThunkPool::Slot*>();
+
+	CallTimer timer(g_monolm._callStats, slot, CallKind::Delegate, method);
+	AllocStats::Scope allocScope(g_monolm._allocStats, slot, CallKind::Delegate, method);
+
+	g_monolm.AttachCurrentThread();
+	g_monolm.PollDebuggingRequest();
+
+	MonoObject* monoDelegate = nullptr;
+	if (slot->bound.load(std::memory_order_acquire)) {
+		monoDelegate = mono_gchandle_get_target(slot->handle.load(std::memory_order_relaxed));
+	}
+	if (!monoDelegate) {
+		g_monolm._provider->Log(std::format(LOG_PREFIX "Callback '{}' called after its delegate was released", method.GetFunctionName()), Severity::Error);
+		ret->SetReturn(uintptr_t{});
+		return;
+	}
+
+	TimeAccount* account = nullptr;
+	if (g_monolm._timeAccounting.IsEnabled()) {
+		if (slot->accountResolved.load(std::memory_order_acquire)) {
+			account = slot->account.load(std::memory_order_relaxed);
+		} else {
+			// Reflection is only paid once per lease, delegates of the core assembly have no account
+			account = g_monolm._timeAccounting.FindAccount(GetDelegateImage(monoDelegate));
+			slot->account.store(account, std::memory_order_relaxed);
+			slot->accountResolved.store(true, std::memory_order_release);
+		}
+	}
+	TimeAccounting::Scope timeScope(g_monolm._timeAccounting, account, TimeKind::Delegate, method.GetName());
 
 	PropertyRef retProp = method.GetReturnType();
 	ValueType retType = retProp.GetType();
@@ -1304,8 +1997,11 @@ void CSharpLanguageModule::DelegateCall(MethodRef method, MemAddr data, const Ji
 	SetParams(paramProps, p, count, hasRet, hasRefs, args);
 
 	MonoObject* exception = nullptr;
+	timer.BeginCallee();
 	MonoObject* result = mono_runtime_delegate_invoke(monoDelegate, args.data(), &exception);
+	timer.EndCallee();
 	if (exception) {
+		timer.SetException();
 		HandleException(exception, nullptr);
 		ret->SetReturn(uintptr_t{});
 		return;
@@ -1699,6 +2395,11 @@ void CSharpLanguageModule::SetReferences(std::span<const PropertyRef> paramProps
 }
 
 void CSharpLanguageModule::SetReturn(PropertyRef retProp, const JitCallback::Parameters* p, const JitCallback::ReturnValue* ret, MonoObject* result) {
+	// mono_runtime_invoke returns value types boxed on the managed heap
+	if (result && g_monolm._allocStats.IsEnabled() && mono_class_is_valuetype(mono_object_get_class(result))) {
+		g_monolm._allocStats.Record(AllocKind::Managed, retProp.GetType(), mono_object_get_size(result));
+	}
+
 	if (result) {
 		switch (retProp.GetType()) {
 			case ValueType::Bool: {
@@ -1978,6 +2679,8 @@ void CSharpLanguageModule::SetReturn(PropertyRef retProp, const JitCallback::Par
 }
 
 LoadResult CSharpLanguageModule::OnPluginLoad(PluginRef plugin) {
+	ScopedPhase loadPhase(_startupProfiler, "OnPluginLoad", "plugin", plugin.GetName());
+
 	MonoImageOpenStatus status = MONO_IMAGE_IMAGE_INVALID;
 
 	fs::path assemblyPath(plugin.GetBaseDir());
@@ -1991,42 +2694,84 @@ LoadResult CSharpLanguageModule::OnPluginLoad(PluginRef plugin) {
 	if (!image)
 		return ErrorData{ "Failed to load assembly image" };
 
+	// Recording starts before the plugin instance is created, so its constructor and everything compiled while binding
+	// exports are part of the profile
+	if (_jitWarmup.IsEnabled()) {
+		fs::path profilePath(assemblyPath);
+		profilePath += ".jitprofile";
+		size_t count = _jitWarmup.Track(_appDomain.get(), image, std::move(profilePath));
+		if (count != 0) {
+			_provider->Log(std::format(LOG_PREFIX "Warming up {} methods of '{}' in background", count, plugin.GetName()), Severity::Debug);
+		}
+	}
+
 	ScriptInstance* script = CreateScriptInstance(plugin, image);
 	if (!script)
 		return ErrorData{ "Failed to find 'Plugin' class implementation" };
 
+	if (_timeAccounting.IsEnabled()) {
+		std::string name(plugin.GetName());
+		auto budget = _settings.pluginBudgets.find(name);
+		script->_account = _timeAccounting.AddAccount(image, std::move(name), budget != _settings.pluginBudgets.end() ? std::make_optional(budget->second) : std::nullopt);
+	}
+
 	std::vector<std::string> methodErrors;
 
 	std::span<const MethodRef> exportedMethods = plugin.GetDescriptor().GetExportedMethods();
 	std::vector<MethodData> methods;
 	methods.reserve(exportedMethods.size());
 
-	for (const auto& method : exportedMethods) {
-		auto separated = Utils::Split(method.GetFunctionName(), ".");
-		size_t size = separated.size();
+	std::optional<MethodIndex> methodIndex;
+	if (!exportedMethods.empty()) {
+		ScopedPhase phase(_startupProfiler, "IndexMethods", "plugin", plugin.GetName());
+		methodIndex.emplace(image);
+	}
+
+	std::vector<std::string> scratchErrors;
 
-		bool noNamespace = (size == 2);
-		if (size != 3 && !noNamespace) {
+	for (const auto& method : exportedMethods) {
+		std::string_view functionName = method.GetFunctionName();
+		if (functionName.find('.') == std::string_view::npos) {
 			methodErrors.emplace_back(std::format("Invalid function format: '{}'. Please provide name in that format: 'Namespace.Class.Method' or 'Namespace.MyParentClass/MyNestedClass.Method' or 'Class.Method'", method.GetFunctionName()));
 			continue;
 		}
 
-		std::string nameSpace(noNamespace ? "" : separated[0]);
-		std::string className(separated[size-2]);
-		std::string methodName(separated[size-1]);
+		auto arity = static_cast<uint32_t>(method.GetParamTypes().size());
 
-		MonoClass* monoClass = mono_class_from_name(image, nameSpace.c_str(), className.c_str());
-		if (!monoClass) {
-			methodErrors.emplace_back(std::format("Failed to find class '{}'", method.GetFunctionName()));
+		std::span<MonoMethod* const> overloads = methodIndex->Find(functionName, arity);
+		if (overloads.empty()) {
+			methodErrors.emplace_back(std::format("Failed to find method '{}' with {} parameters", method.GetFunctionName(), arity));
 			continue;
 		}
 
-		MonoMethod* monoMethod = mono_class_get_method_from_name(monoClass, methodName.c_str(), -1);
-		if (!monoMethod) {
-			methodErrors.emplace_back(std::format("Failed to find method '{}'", method.GetFunctionName()));
-			continue;
+		std::optional<ScopedPhase> validatePhase;
+		validatePhase.emplace(_startupProfiler, method.GetFunctionName(), "validate", plugin.GetName());
+
+		MonoMethod* monoMethod = nullptr;
+		if (overloads.size() == 1) {
+			if (ValidateSignature(method, overloads[0], methodErrors)) {
+				monoMethod = overloads[0];
+			}
+		} else {
+			// Pick the overload which matches the manifest signature
+			for (MonoMethod* overload : overloads) {
+				scratchErrors.clear();
+				if (ValidateSignature(method, overload, scratchErrors)) {
+					monoMethod = overload;
+					break;
+				}
+			}
+			if (!monoMethod) {
+				methodErrors.emplace_back(std::format("None of {} overloads of method '{}' match signature", overloads.size(), method.GetFunctionName()));
+			}
 		}
 
+		if (!monoMethod)
+			continue;
+
+		validatePhase.reset();
+
+		MonoClass* monoClass = mono_method_get_class(monoMethod);
 		MonoObject* monoInstance = monoClass == script->_klass ? script->_instance : nullptr;
 
 		uint32_t methodFlags = mono_method_get_flags(monoMethod, nullptr);
@@ -2035,108 +2780,153 @@ LoadResult CSharpLanguageModule::OnPluginLoad(PluginRef plugin) {
 			continue;
 		}
 
-		MonoMethodSignature* sig = mono_method_signature(monoMethod);
+		ScopedPhase jitPhase(_startupProfiler, method.GetFunctionName(), "jit", plugin.GetName());
 
-		uint32_t paramCount = mono_signature_get_param_count(sig);
-		std::span<const PropertyRef> paramTypes = method.GetParamTypes();
-		if (paramCount != paramTypes.size()) {
-			methodErrors.emplace_back(std::format("Method '{}' has invalid parameter count {} when it should have {}", method.GetFunctionName(), paramTypes.size(), paramCount));
-			continue;
+		// Direct entry points bypass InternalCall, so they are not measured by the call statistics, time accounting or call trace
+		if (_settings.directExports && !_callStats.IsEnabled() && !_timeAccounting.IsEnabled() && !_callRecorder.IsOpen() && IsMethodDirectCapable(method)) {
+			if (void* entryPoint = CreateDirectEntryPoint(monoMethod, monoInstance)) {
+				methods.emplace_back(method, entryPoint);
+				continue;
+			}
 		}
 
-		MonoType* returnType = mono_signature_get_return_type(sig);
-		char* returnTypeName = mono_type_get_name(returnType);
-		ValueType retType = MonoTypeToValueType(returnTypeName);
+		auto exportMethod = std::make_unique<ExportMethod>(monoMethod, monoInstance, script->_account, _callRecorder.AddMethod(plugin.GetName(), method));
 
-		if (retType == ValueType::Invalid) {
-			MonoClass* returnClass = mono_class_from_mono_type(returnType);
-			if (mono_class_is_delegate(returnClass)) {
-				retType = ValueType::Function;
-			}
+		JitCallback callback(_rt);
+		MemAddr methodAddr = callback.GetJitFunc(method, &InternalCall, exportMethod.get());
+		if (!methodAddr) {
+			methodErrors.emplace_back(std::format("Method '{}' has JIT generation error: {}", method.GetFunctionName(), callback.GetError()));
+			continue;
 		}
+		_functions.Emplace(exportMethod.get(), std::make_pair(std::move(callback), JitCall(_rt)));
+		_exportMethods.emplace_back(std::move(exportMethod));
 
-		if (retType == ValueType::Invalid) {
-			methodErrors.emplace_back(std::format("Return of method '{}' not supported '{}'", method.GetFunctionName(), returnTypeName));
-			continue;
+		if (_perfMap.IsOpen()) {
+			_perfMap.AddTrampoline(methodAddr, "export", std::format("{}.{}", plugin.GetName(), method.GetName()));
 		}
 
-		ValueType methodReturnType = method.GetReturnType().GetType();
+		methods.emplace_back(method, methodAddr);
+	}
 
-		if (methodReturnType == ValueType::Char8 && retType == ValueType::Char16) {
-			retType = ValueType::Char8;
-		} else if (methodReturnType == ValueType::ArrayChar8 && retType == ValueType::ArrayChar16) {
-			retType = ValueType::ArrayChar8;
+	if (!methodErrors.empty()) {
+		std::string funcs(methodErrors[0]);
+		for (auto it = std::next(methodErrors.begin()); it != methodErrors.end(); ++it) {
+			std::format_to(std::back_inserter(funcs), ", {}", *it);
 		}
+		return ErrorData{ funcs };
+	}
 
-		if (retType != methodReturnType) {
-			methodErrors.emplace_back(std::format("Method '{}' has invalid return type '{}' when it should have '{}'", method.GetFunctionName(), ValueUtils::ToString(methodReturnType), ValueUtils::ToString(retType)));
-			continue;
+	if (_samplingProfiler.IsEnabled()) {
+		_samplingProfiler.AddImage(image, std::string(plugin.GetName()));
+	}
+
+	if (_heapSnapshot.IsEnabled()) {
+		_heapSnapshot.AddImage(image, std::string(plugin.GetName()));
+	}
+
+	return LoadResultData{ std::move(methods) };
+}
+
+void* CSharpLanguageModule::CreateDirectEntryPoint(MonoMethod* method, MonoObject* instance) {
+	if (!_createEntryPoint)
+		return nullptr;
+
+	MonoReflectionMethod* methodInfo = mono_method_get_object(_appDomain.get(), method, nullptr);
+	if (!methodInfo)
+		return nullptr;
+
+	void* args[] = { methodInfo, instance };
+	MonoObject* exception = nullptr;
+	MonoObject* result = mono_runtime_invoke(_createEntryPoint, nullptr, args, &exception);
+	if (exception || !result) {
+		// The generic call path still works, so the failure is not fatal
+		if (exception) {
+			HandleException(exception, nullptr);
 		}
+		return nullptr;
+	}
+	return *reinterpret_cast<void**>(mono_object_unbox(result));
+}
+
+ValueType CSharpLanguageModule::MonoTypeToValueType(MonoType* type) {
+	// Byref types report the type enum of the referenced type
+	int typeEnum = mono_type_get_type(type);
+	switch (typeEnum) {
+		case MONO_TYPE_SZARRAY:
+			return MonoElementToArrayValueType(mono_class_get_element_class(mono_class_from_mono_type(type)));
+		case MONO_TYPE_VALUETYPE:
+		case MONO_TYPE_CLASS:
+		case MONO_TYPE_GENERICINST:
+			return MonoClassToValueType(mono_class_from_mono_type(type));
+		default:
+			return MonoPrimitiveToValueType(typeEnum);
+	}
+}
 
-		bool methodFail = false;
+ValueType CSharpLanguageModule::MonoClassToValueType(MonoClass* klass) {
+	if (!klass)
+		return ValueType::Invalid;
 
-		size_t i = 0;
-		void* iter = nullptr;
-		while (MonoType* type = mono_signature_get_params(sig, &iter)) {
-			char* paramTypeName = mono_type_get_name(type);
-			ValueType paramType = MonoTypeToValueType(paramTypeName);
+	auto it = _classTypes.find(klass);
+	if (it != _classTypes.end())
+		return std::get<ValueType>(*it);
 
-			if (paramType == ValueType::Invalid) {
-				MonoClass* paramClass = mono_class_from_mono_type(type);
-				if (mono_class_is_delegate(paramClass)) {
-					paramType = ValueType::Function;
-				}
-			}
+	// System.Delegate and the System.Numerics types are seeded at init
+	ValueType valueType = mono_class_is_delegate(klass) ? ValueType::Function : ValueType::Invalid;
+	_classTypes.emplace(klass, valueType);
+	return valueType;
+}
 
-			if (paramType == ValueType::Invalid) {
-				methodFail = true;
-				methodErrors.emplace_back(std::format("Parameter at index '{}' of method '{}' not supported '{}'", i, method.GetFunctionName(), paramTypeName));
-				continue;
-			}
+bool CSharpLanguageModule::ValidateSignature(MethodRef method, MonoMethod* monoMethod, std::vector<std::string>& errors) {
+	MonoMethodSignature* sig = mono_method_signature(monoMethod);
 
-			ValueType methodParamType = paramTypes[i].GetType();
+	uint32_t paramCount = mono_signature_get_param_count(sig);
+	std::span<const PropertyRef> paramTypes = method.GetParamTypes();
+	if (paramCount != paramTypes.size()) {
+		errors.emplace_back(std::format("Method '{}' has invalid parameter count {} when it should have {}", method.GetFunctionName(), paramTypes.size(), paramCount));
+		return false;
+	}
 
-			if (methodParamType == ValueType::Char8 && paramType == ValueType::Char16) {
-				paramType = ValueType::Char8;
-			} else if (methodParamType == ValueType::ArrayChar8 && paramType == ValueType::ArrayChar16) {
-				paramType = ValueType::ArrayChar8;
-			}
+	MonoType* returnType = mono_signature_get_return_type(sig);
+	ValueType retType = MonoTypeToValueType(returnType);
 
-			if (paramType != methodParamType) {
-				methodFail = true;
-				methodErrors.emplace_back(std::format("Method '{}' has invalid param type '{}' at index {} when it should have '{}'", method.GetFunctionName(), ValueUtils::ToString(methodParamType), i, ValueUtils::ToString(paramType)));
-				continue;
-			}
+	if (retType == ValueType::Invalid) {
+		errors.emplace_back(std::format("Return of method '{}' not supported '{}'", method.GetFunctionName(), GetTypeName(returnType)));
+		return false;
+	}
 
-			i++;
-		}
+	ValueType methodReturnType = method.GetReturnType().GetType();
+	retType = AdjustCharType(retType, methodReturnType);
 
-		if (methodFail)
-			continue;
+	if (retType != methodReturnType) {
+		errors.emplace_back(std::format("Method '{}' has invalid return type '{}' when it should have '{}'", method.GetFunctionName(), ValueUtils::ToString(methodReturnType), ValueUtils::ToString(retType)));
+		return false;
+	}
 
-		auto exportMethod = std::make_unique<ExportMethod>(monoMethod, monoInstance);
+	bool result = true;
 
-		JitCallback callback(_rt);
-		MemAddr methodAddr = callback.GetJitFunc(method, &InternalCall, exportMethod.get());
-		if (!methodAddr) {
-			methodErrors.emplace_back(std::format("Method '{}' has JIT generation error: {}", method.GetFunctionName(), callback.GetError()));
+	size_t i = 0;
+	void* iter = nullptr;
+	for (; MonoType* type = mono_signature_get_params(sig, &iter); ++i) {
+		ValueType paramType = MonoTypeToValueType(type);
+
+		if (paramType == ValueType::Invalid) {
+			result = false;
+			errors.emplace_back(std::format("Parameter at index '{}' of method '{}' not supported '{}'", i, method.GetFunctionName(), GetTypeName(type)));
 			continue;
 		}
-		_functions.emplace(exportMethod.get(), std::make_pair(std::move(callback), JitCall(_rt)));
-		_exportMethods.emplace_back(std::move(exportMethod));
 
-		methods.emplace_back(method, methodAddr);
-	}
+		ValueType methodParamType = paramTypes[i].GetType();
+		paramType = AdjustCharType(paramType, methodParamType);
 
-	if (!methodErrors.empty()) {
-		std::string funcs(methodErrors[0]);
-		for (auto it = std::next(methodErrors.begin()); it != methodErrors.end(); ++it) {
-			std::format_to(std::back_inserter(funcs), ", {}", *it);
+		if (paramType != methodParamType) {
+			result = false;
+			errors.emplace_back(std::format("Method '{}' has invalid param type '{}' at index {} when it should have '{}'", method.GetFunctionName(), ValueUtils::ToString(methodParamType), i, ValueUtils::ToString(paramType)));
+			continue;
 		}
-		return ErrorData{ funcs };
 	}
 
-	return LoadResultData{ std::move(methods) };
+	return result;
 }
 
 bool CSharpLanguageModule::IsDebugBuild() {
@@ -2144,6 +2934,8 @@ bool CSharpLanguageModule::IsDebugBuild() {
 }
 
 void CSharpLanguageModule::OnMethodExport(PluginRef plugin) {
+	ScopedPhase phase(_startupProfiler, "OnMethodExport", "plugin", plugin.GetName());
+
 	for (const auto& [method, addr] : plugin.GetMethods()) {
 		auto funcName = std::format("{}.{}::{}", plugin.GetName(), plugin.GetName(), method.GetName());
 
@@ -2152,7 +2944,44 @@ void CSharpLanguageModule::OnMethodExport(PluginRef plugin) {
 			continue;
 		}
 
-		if (IsMethodPrimitive(method)) {
+		bool gcSafe = std::find(_settings.gcSafeMethods.begin(), _settings.gcSafeMethods.end(), std::format("{}.{}", plugin.GetName(), method.GetName())) != _settings.gcSafeMethods.end();
+		// The threshold only watches methods which are marshalled anyway, primitive ones keep their direct internal call
+		bool watched = _settings.gcSafeThresholdUs != 0 && !IsMethodPrimitive(method);
+		bool gcSafeCapable = (gcSafe || watched) && IsMethodGcSafeCapable(method);
+		if (gcSafe && !gcSafeCapable) {
+			_provider->Log(std::format(LOG_PREFIX "Method '{}' can not run in GC safe mode, it passes delegates or references to managed memory", funcName), Severity::Warning);
+		}
+
+		// Call statistics need a per-method record, so every import goes through the tracked path
+		bool tracked = gcSafeCapable || _callStats.IsEnabled();
+
+		if (tracked) {
+			JitCall call(_rt);
+			MemAddr callerAddr = call.GetJitFunc(method, addr);
+			if (!callerAddr) {
+				_provider->Log(std::format(LOG_PREFIX "{}: {}", method.GetFunctionName(), call.GetError()), Severity::Error);
+				continue;
+			}
+			auto import = std::make_unique<ImportMethod>();
+			import->func = callerAddr.RCast<JitCall::CallingFunc>();
+			import->gcSafe = gcSafe && gcSafeCapable;
+			import->gcSafeCapable = gcSafeCapable;
+			JitCallback callback(_rt);
+			MemAddr methodAddr = callback.GetJitFunc(method, &ExternalCallTracked, import.get(), [](ValueType type) { return ValueUtils::IsBetween(type, ValueType::_HiddenParamStart, ValueType::_StructEnd); });
+			if (!methodAddr) {
+				_provider->Log(std::format(LOG_PREFIX "{}: {}", method.GetFunctionName(), callback.GetError()), Severity::Error);
+				continue;
+			}
+			_functions.Emplace(methodAddr, std::make_pair(std::move(callback), std::move(call)));
+			_trackedImports.emplace_back(std::move(import));
+
+			if (_perfMap.IsOpen()) {
+				_perfMap.AddTrampoline(methodAddr, "import", funcName);
+				_perfMap.AddTrampoline(callerAddr, "call", funcName);
+			}
+
+			mono_add_internal_call(funcName.c_str(), methodAddr);
+		} else if (IsMethodPrimitive(method)) {
 			mono_add_internal_call(funcName.c_str(), addr);
 		} else {
 			JitCall call(_rt);
@@ -2167,7 +2996,12 @@ void CSharpLanguageModule::OnMethodExport(PluginRef plugin) {
 				_provider->Log(std::format(LOG_PREFIX "{}: {}", method.GetFunctionName(), callback.GetError()), Severity::Error);
 				continue;
 			}
-			_functions.emplace(methodAddr, std::make_pair(std::move(callback), std::move(call)));
+			_functions.Emplace(methodAddr, std::make_pair(std::move(callback), std::move(call)));
+
+			if (_perfMap.IsOpen()) {
+				_perfMap.AddTrampoline(methodAddr, "import", funcName);
+				_perfMap.AddTrampoline(callerAddr, "call", funcName);
+			}
 
 			mono_add_internal_call(funcName.c_str(), methodAddr);
 		}
@@ -2177,43 +3011,98 @@ void CSharpLanguageModule::OnMethodExport(PluginRef plugin) {
 }
 
 void CSharpLanguageModule::OnPluginStart(PluginRef plugin) {
-	ScriptInstance* script = FindScript(plugin.GetId());
-	if (script) {
-		script->InvokeOnStart();
+	{
+		ScopedPhase phase(_startupProfiler, "OnPluginStart", "plugin", plugin.GetName());
+
+		ScriptInstance* script = FindScript(plugin.GetId());
+		if (script) {
+			script->InvokeOnStart();
+		}
+	}
+
+	// Startup is complete once every loaded plugin has started, write the trace and the JIT profiles now rather than at
+	// shutdown, which a crashed or killed server never reaches
+	if (++_startedPlugins >= _scripts.size()) {
+		FlushStartupTrace();
+		SaveJitProfiles();
+	}
+}
+
+void CSharpLanguageModule::SaveJitProfiles() {
+	if (!_jitWarmup.IsEnabled())
+		return;
+
+	for (const auto& [_, script] : _scripts) {
+		if (!_jitWarmup.Save(script._image)) {
+			_provider->Log(std::format(LOG_PREFIX "Failed to save JIT profile of '{}'", script.GetPlugin().GetName()), Severity::Warning);
+		}
+	}
+}
+
+void CSharpLanguageModule::FlushStartupTrace() {
+	if (!_startupProfiler.IsEnabled())
+		return;
+
+	if (_startupProfiler.Flush()) {
+		_provider->Log(std::format(LOG_PREFIX "Startup trace written to: {}", _startupProfiler.GetOutputPath().string()), Severity::Info);
+	} else {
+		_provider->Log(std::format(LOG_PREFIX "Failed to write startup trace: {}", _startupProfiler.GetOutputPath().string()), Severity::Warning);
 	}
+	_startupProfiler.Disable();
 }
 
 void CSharpLanguageModule::OnPluginEnd(PluginRef plugin) {
 	ScriptInstance* script = FindScript(plugin.GetId());
 	if (script) {
 		script->InvokeOnEnd();
+
+		if (_jitWarmup.IsEnabled()) {
+			if (!_jitWarmup.Save(script->_image)) {
+				_provider->Log(std::format(LOG_PREFIX "Failed to save JIT profile of '{}'", plugin.GetName()), Severity::Warning);
+			}
+			_jitWarmup.Untrack(script->_image);
+		}
 	}
 }
 
 ScriptInstance* CSharpLanguageModule::CreateScriptInstance(PluginRef plugin, MonoImage* image) {
-	const MonoTableInfo* typeDefinitionsTable = mono_image_get_table_info(image, MONO_TABLE_TYPEDEF);
-	int numTypes = mono_table_info_get_rows(typeDefinitionsTable);
+	MonoClass* pluginClass = nullptr;
+
+	{
+		ScopedPhase phase(_startupProfiler, "ScanTypes", "plugin", plugin.GetName());
+
+		const MonoTableInfo* typeDefinitionsTable = mono_image_get_table_info(image, MONO_TABLE_TYPEDEF);
+		int numTypes = mono_table_info_get_rows(typeDefinitionsTable);
 
-	for (int i = 0; i < numTypes; ++i) {
-		uint32_t cols[MONO_TYPEDEF_SIZE];
-		mono_metadata_decode_row(typeDefinitionsTable, i, cols, MONO_TYPEDEF_SIZE);
+		for (int i = 0; i < numTypes; ++i) {
+			uint32_t cols[MONO_TYPEDEF_SIZE];
+			mono_metadata_decode_row(typeDefinitionsTable, i, cols, MONO_TYPEDEF_SIZE);
 
-		const char* nameSpace = mono_metadata_string_heap(image, cols[MONO_TYPEDEF_NAMESPACE]);
-		const char* className = mono_metadata_string_heap(image, cols[MONO_TYPEDEF_NAME]);
+			const char* nameSpace = mono_metadata_string_heap(image, cols[MONO_TYPEDEF_NAMESPACE]);
+			const char* className = mono_metadata_string_heap(image, cols[MONO_TYPEDEF_NAME]);
 
-		MonoClass* monoClass = mono_class_from_name(image, nameSpace, className);
-		if (monoClass == _plugin.klass)
-			continue;
+			MonoClass* monoClass = mono_class_from_name(image, nameSpace, className);
+			if (monoClass == _plugin.klass)
+				continue;
 
-		bool isPlugin = mono_class_is_subclass_of(monoClass, _plugin.klass, false);
-		if (!isPlugin)
-			continue;
+			bool isPlugin = mono_class_is_subclass_of(monoClass, _plugin.klass, false);
+			if (!isPlugin)
+				continue;
 
-		const auto [it, result] = _scripts.try_emplace(plugin.GetId(), plugin, image, monoClass);
-		if (result)
-			return &std::get<ScriptInstance>(*it);
+			pluginClass = monoClass;
+			break;
+		}
 	}
 
+	if (!pluginClass)
+		return nullptr;
+
+	ScopedPhase phase(_startupProfiler, "ScriptInstance", "plugin", plugin.GetName());
+
+	const auto [it, result] = _scripts.try_emplace(plugin.GetId(), plugin, image, pluginClass);
+	if (result)
+		return &std::get<ScriptInstance>(*it);
+
 	return nullptr;
 }
 
@@ -2225,12 +3114,10 @@ ScriptInstance* CSharpLanguageModule::FindScript(UniqueId id) {
 }
 
 MonoDelegate* CSharpLanguageModule::CreateDelegate(void* func, plugify::MethodRef method) {
-	auto it = _cachedDelegates.find(func);
-	if (it != _cachedDelegates.end()) {
-		MonoObject* object = mono_gchandle_get_target(std::get<uint32_t>(*it));
-		if (object != nullptr) {
-			return reinterpret_cast<MonoDelegate*>(object);
-		}
+	MonoObject* cachedObject = nullptr;
+	_cachedDelegates.Find(func, [&cachedObject](uint32_t ref) { cachedObject = mono_gchandle_get_target(ref); });
+	if (cachedObject != nullptr) {
+		return reinterpret_cast<MonoDelegate*>(cachedObject);
 	}
 
 	// TODO@ Find better way to lookup for delegate inside scripts, probably we need more info from core
@@ -2290,17 +3177,24 @@ MonoDelegate* CSharpLanguageModule::CreateDelegate(void* func, plugify::MethodRe
 
 		delegate = mono_ftnptr_to_delegate(monoClass, methodAddr);
 
+		if (_perfMap.IsOpen()) {
+			_perfMap.AddTrampoline(methodAddr, "callback", delegateName);
+			_perfMap.AddTrampoline(callerAddr, "call", delegateName);
+		}
+
 		// Attach dtor events to delegate
 		mono_gc_reference_queue_add(_callReferenceQueue.get(), reinterpret_cast<MonoObject*>(delegate), reinterpret_cast<void*>(call));
 		mono_gc_reference_queue_add(_callbackReferenceQueue.get(), reinterpret_cast<MonoObject*>(delegate), reinterpret_cast<void*>(callback));
+		g_delegateCalls.fetch_add(1, std::memory_order_relaxed);
+		g_delegateCallbacks.fetch_add(1, std::memory_order_relaxed);
 	}
 
 	uint32_t ref = mono_gchandle_new_weakref(reinterpret_cast<MonoObject*>(delegate), 0);
 
-	if (it != _cachedDelegates.end()) {
-		std::get<uint32_t>(*it) = ref;
-	} else {
-		_cachedDelegates.emplace(func, ref);
+	_cachedDelegates.InsertOrAssign(func, ref);
+
+	if (_allocStats.IsEnabled()) {
+		_allocStats.Record(AllocKind::Managed, ValueType::Function, mono_object_get_size(reinterpret_cast<MonoObject*>(delegate)));
 	}
 
 	return delegate;
@@ -2311,11 +3205,16 @@ MonoString* CSharpLanguageModule::CreateString(const T& source) const {
 	if (source.empty()) {
 		return mono_string_empty(_appDomain.get());
 	}
+	MonoString* string;
 	if constexpr (std::same_as<T, std::wstring_view>) {
-		return mono_string_new_utf16(_appDomain.get(), source.data(), static_cast<int32_t>(source.size()));
+		string = mono_string_new_utf16(_appDomain.get(), source.data(), static_cast<int32_t>(source.size()));
 	} else {
-		return mono_string_new(_appDomain.get(), source.data());
+		string = mono_string_new(_appDomain.get(), source.data());
+	}
+	if (_allocStats.IsEnabled()) {
+		_allocStats.Record(AllocKind::Managed, ValueType::String, mono_object_get_size(reinterpret_cast<MonoObject*>(string)));
 	}
+	return string;
 }
 
 template<typename T>
@@ -2332,7 +3231,11 @@ MonoArray* CSharpLanguageModule::CreateArrayT(const std::vector<T>& source, Mono
 }
 
 MonoArray* CSharpLanguageModule::CreateArray(MonoClass* klass, size_t count) const {
-	return mono_array_new(_appDomain.get(), klass, count);
+	MonoArray* array = mono_array_new(_appDomain.get(), klass, count);
+	if (_allocStats.IsEnabled()) {
+		_allocStats.Record(AllocKind::Managed, MonoElementToArrayValueType(klass), mono_object_get_size(reinterpret_cast<MonoObject*>(array)));
+	}
+	return array;
 }
 
 template<typename T>
@@ -2464,27 +3367,123 @@ ScriptInstance::ScriptInstance(PluginRef plugin, MonoImage* image, MonoClass* kl
 			g_monolm.CreateStringArray(dependencies),
 	};
 	mono_runtime_invoke(g_monolm._plugin.ctor, _instance, args.data(), nullptr);
+
+	// Resolved once, later invocations go through the unmanaged thunks
+	if (MonoMethod* onStartMethod = mono_class_get_method_from_name(klass, "OnStart", 0)) {
+		_onStart = reinterpret_cast<InstanceThunk>(mono_method_get_unmanaged_thunk(onStartMethod));
+	}
+	if (MonoMethod* onEndMethod = mono_class_get_method_from_name(klass, "OnEnd", 0)) {
+		_onEnd = reinterpret_cast<InstanceThunk>(mono_method_get_unmanaged_thunk(onEndMethod));
+	}
+}
+
+void ScriptInstance::InvokeThunk(InstanceThunk thunk, MonoObject* instance) {
+	MonoException* exception = nullptr;
+	thunk(instance, &exception);
+	if (exception) {
+		CSharpLanguageModule::HandleException(reinterpret_cast<MonoObject*>(exception), nullptr);
+	}
 }
 
 void ScriptInstance::InvokeOnStart() const {
-	MonoMethod* onStartMethod = mono_class_get_method_from_name(_klass, "OnStart", 0);
-	if (onStartMethod) {
-		MonoObject* exception = nullptr;
-		mono_runtime_invoke(onStartMethod, _instance, nullptr, &exception);
-		if (exception) {
-			CSharpLanguageModule::HandleException(exception, nullptr);
-		}
+	if (_onStart) {
+		TimeAccounting::Scope timeScope(g_monolm._timeAccounting, _account, TimeKind::Lifecycle, "OnStart");
+		InvokeThunk(_onStart, _instance);
 	}
+
+	// Per tick callbacks only reach plugins which have started
+	InvokeThunk(g_monolm._lifecycle.registerPlugin, _instance);
 }
 
 void ScriptInstance::InvokeOnEnd() const {
-	MonoMethod* onEndMethod  = mono_class_get_method_from_name(_klass, "OnEnd", 0);
-	if (onEndMethod) {
-		MonoObject* exception = nullptr;
-		mono_runtime_invoke(onEndMethod, _instance, nullptr, &exception);
-		if (exception) {
-			CSharpLanguageModule::HandleException(exception, nullptr);
-		}
+	InvokeThunk(g_monolm._lifecycle.unregisterPlugin, _instance);
+
+	if (_onEnd) {
+		TimeAccounting::Scope timeScope(g_monolm._timeAccounting, _account, TimeKind::Lifecycle, "OnEnd");
+		InvokeThunk(_onEnd, _instance);
+	}
+}
+
+std::string CSharpLanguageModule::TakeHeapSnapshot() {
+	if (!_heapSnapshot.IsEnabled() || !_rt)
+		return {};
+
+	// The module containers counted below are only modified on the main thread, while loading plugins
+	if (!_scheduler.IsMainThread()) {
+		_provider->Log(LOG_PREFIX "Heap snapshots can only be taken on the main thread", Severity::Error);
+		return {};
+	}
+
+	AttachCurrentThread();
+
+	auto figure = [](std::string_view name, auto value) {
+		return NativeFigure{ name, static_cast<int64_t>(value) };
+	};
+
+	// Every function pair, delegate thunk and native delegate wrapper owns its own JIT code
+	asmjit::JitAllocator::Statistics jit = _rt->allocator()->statistics();
+	size_t functions = _functions.Size();
+	size_t thunks = _thunkPool.GetSlotCount();
+	int64_t delegateCallbacks = g_delegateCallbacks.load(std::memory_order_relaxed);
+	int64_t delegateCalls = g_delegateCalls.load(std::memory_order_relaxed);
+
+	const NativeFigure native[] = {
+		figure("jit.code_used_bytes", jit.usedSize()),
+		figure("jit.code_reserved_bytes", jit.reservedSize()),
+		figure("jit.code_blocks", jit.blockCount()),
+		figure("jit.code_allocations", jit.allocationCount()),
+		figure("jit.callbacks", static_cast<int64_t>(functions + thunks) + delegateCallbacks),
+		figure("jit.calls", static_cast<int64_t>(functions) + delegateCalls),
+		figure("jit.function_pairs", functions),
+		figure("jit.delegate_thunks", thunks),
+		figure("jit.delegate_thunks_free", _thunkPool.GetFreeCount()),
+		figure("jit.native_delegates", delegateCallbacks),
+		figure("cache.functions", _cachedFunctions.Size()),
+		figure("cache.delegates", _cachedDelegates.Size()),
+		figure("cache.class_types", _classTypes.size()),
+		figure("exports", _exportMethods.size()),
+		figure("imports.tracked", _trackedImports.size()),
+		figure("scripts", _scripts.size()),
+	};
+	return _heapSnapshot.Take(native);
+}
+
+void CSharpLanguageModule::Update(float deltaTime) {
+	// The first tick also ends startup when some loaded plugin was never started
+	if (_startupProfiler.IsEnabled()) {
+		FlushStartupTrace();
+	}
+
+	if (!_lifecycle.update)
+		return;
+
+	AttachCurrentThread();
+	PollDebuggingRequest();
+
+	_callRecorder.AddTick(deltaTime);
+
+	MonoException* exception = nullptr;
+	_lifecycle.update(deltaTime, &exception);
+	if (exception) {
+		HandleException(reinterpret_cast<MonoObject*>(exception), nullptr);
+	}
+
+	if (_timeAccounting.IsEnabled()) {
+		_timeAccounting.EndTick();
+	}
+}
+
+void CSharpLanguageModule::FixedUpdate(float deltaTime) {
+	if (!_lifecycle.fixedUpdate)
+		return;
+
+	AttachCurrentThread();
+	PollDebuggingRequest();
+
+	MonoException* exception = nullptr;
+	_lifecycle.fixedUpdate(deltaTime, &exception);
+	if (exception) {
+		HandleException(reinterpret_cast<MonoObject*>(exception), nullptr);
 	}
 }
 
@@ -2492,6 +3491,68 @@ namespace monolm {
 	CSharpLanguageModule g_monolm;
 }
 
+namespace {
+	/// Copies a report into a caller owned buffer (always null-terminated), returns the full report length.
+	size_t CopyReport(const std::string& report, char* buffer, size_t size) {
+		if (buffer && size != 0) {
+			size_t length = std::min(report.size(), size - 1);
+			std::memcpy(buffer, report.data(), length);
+			buffer[length] = '\0';
+		}
+		return report.size();
+	}
+}
+
 plugify::ILanguageModule* GetLanguageModule() {
 	return &monolm::g_monolm;
 }
+
+size_t MonoLM_PumpMainThread(uint32_t budgetUs) {
+	return monolm::g_monolm.GetScheduler().Pump(std::chrono::microseconds(budgetUs));
+}
+
+size_t MonoLM_GetCallStats(char* buffer, size_t size) {
+	return CopyReport(monolm::g_monolm.GetCallStats().Report(), buffer, size);
+}
+
+bool MonoLM_GetGcSummary(monolm::GcSummary* summary) {
+	monolm::GcMonitor& monitor = monolm::g_monolm.GetGcMonitor();
+	if (!summary || !monitor.IsEnabled())
+		return false;
+	*summary = monitor.GetSummary();
+	return true;
+}
+
+bool MonoLM_WriteGcTrace(const char* path) {
+	monolm::GcMonitor& monitor = monolm::g_monolm.GetGcMonitor();
+	if (!path || !monitor.IsEnabled())
+		return false;
+	return monitor.WriteTrace(path);
+}
+
+size_t MonoLM_GetAllocStats(char* buffer, size_t size) {
+	return CopyReport(monolm::g_monolm.GetAllocStats().Report(), buffer, size);
+}
+
+bool MonoLM_WriteHeapSnapshot(const char* path) {
+	if (!path || !monolm::g_monolm.IsHeapSnapshotEnabled())
+		return false;
+	std::string snapshot = monolm::g_monolm.TakeHeapSnapshot();
+	if (snapshot.empty())
+		return false;
+	std::ofstream stream(path, std::ios::trunc);
+	stream << snapshot;
+	return stream.good();
+}
+
+size_t MonoLM_GetTimeStats(char* buffer, size_t size) {
+	return CopyReport(monolm::g_monolm.GetTimeAccounting().Report(), buffer, size);
+}
+
+void MonoLM_Update(float deltaTime) {
+	monolm::g_monolm.Update(deltaTime);
+}
+
+void MonoLM_FixedUpdate(float deltaTime) {
+	monolm::g_monolm.FixedUpdate(deltaTime);
+}
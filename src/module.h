@@ -11,6 +11,20 @@
 #include <plugify/method.h>
 #include <plugify/plugin.h>
 
+#include "alloc_stats.h"
+#include "call_recorder.h"
+#include "call_stats.h"
+#include "concurrent_map.h"
+#include "gc_monitor.h"
+#include "heap_snapshot.h"
+#include "jit_warmup.h"
+#include "perf_map.h"
+#include "sampling_profiler.h"
+#include "scheduler.h"
+#include "thunk_pool.h"
+#include "time_accounting.h"
+#include "trace.h"
+
 extern "C" {
 	typedef struct _MonoClass MonoClass;
 	typedef struct _MonoObject MonoObject;
@@ -24,6 +38,9 @@ extern "C" {
 	typedef struct _MonoDelegate MonoDelegate;
 	typedef struct _MonoString MonoString;
 	typedef struct _MonoDomain MonoDomain;
+	typedef struct _MonoType MonoType;
+	typedef struct _MonoThread MonoThread;
+	typedef struct _MonoException MonoException;
 	typedef int32_t mono_bool;
 }
 
@@ -33,6 +50,11 @@ struct std::default_delete<MonoReferenceQueue> {
 };
 
 namespace monolm {
+	/// Unmanaged thunks from mono_method_get_unmanaged_thunk, the exception is returned through the last parameter.
+	using InstanceThunk = void(*)(MonoObject* instance, MonoException** exc);
+	using TickThunk = void(*)(float deltaTime, MonoException** exc);
+	using StaticThunk = void(*)(MonoException** exc);
+
 	class ScriptInstance {
 	public:
 		ScriptInstance(plugify::PluginRef plugin, MonoImage* image, MonoClass* klass);
@@ -46,11 +68,16 @@ namespace monolm {
 		void InvokeOnStart() const;
 		void InvokeOnEnd() const;
 
+		static void InvokeThunk(InstanceThunk thunk, MonoObject* instance);
+
 	private:
 		plugify::PluginRef _plugin;
 		MonoImage* _image;
 		MonoClass* _klass;
 		MonoObject* _instance;
+		InstanceThunk _onStart{ nullptr };
+		InstanceThunk _onEnd{ nullptr };
+		TimeAccount* _account{ nullptr };
 
 		friend class CSharpLanguageModule;
 	};
@@ -74,14 +101,26 @@ namespace monolm {
 	using ArgumentList = std::vector<void*>;
 	using Function = std::pair<plugify::JitCallback, plugify::JitCall>;
 
-	/*struct ImportMethod {
-		MethodRef method;
-		void* addr{ nullptr };
-	};*/
+	/// Native export whose calls are routed through ExternalCallTracked.
+	struct ImportMethod {
+		plugify::JitCall::CallingFunc func{ nullptr };
+		std::atomic<bool> gcSafe{ false };
+		bool gcSafeCapable{ false };
+	};
 
 	struct ExportMethod {
 		MonoMethod* method{ nullptr };
 		MonoObject* instance{ nullptr };
+		TimeAccount* account{ nullptr };
+		uint32_t traceId{ 0 };
+	};
+
+	struct LifecycleInfo {
+		InstanceThunk registerPlugin{ nullptr };
+		InstanceThunk unregisterPlugin{ nullptr };
+		TickThunk update{ nullptr };
+		TickThunk fixedUpdate{ nullptr };
+		StaticThunk resetAbort{ nullptr };
 	};
 
 	struct AssemblyInfo {
@@ -94,6 +133,16 @@ namespace monolm {
 		MonoMethod* ctor{ nullptr };
 	};
 
+	/// JIT and sgen tuning, applied before the runtime starts.
+	struct RuntimeSettings {
+		std::string preset; // "latency" or "throughput", explicit values take precedence
+		std::string optimize; // value of --optimize, e.g. "all" or "-inline"
+		std::string nurserySize; // power of two with k/m/g suffix
+		std::string majorMode; // "balanced", "throughput" or "pause[:max-pause-ms]"
+		std::optional<bool> concurrentMark;
+		std::string softHeapLimit; // size with k/m/g suffix
+	};
+
 	class CSharpLanguageModule final : public plugify::ILanguageModule {
 	public:
 		CSharpLanguageModule() = default;
@@ -112,6 +161,16 @@ namespace monolm {
 		ScriptInstance* FindScript(plugify::UniqueId id);
 
 		const std::shared_ptr<plugify::IPlugifyProvider>& GetProvider() { return _provider; }
+		StartupProfiler& GetStartupProfiler() { return _startupProfiler; }
+		Scheduler& GetScheduler() { return _scheduler; }
+		CallStats& GetCallStats() { return _callStats; }
+		AllocStats& GetAllocStats() { return _allocStats; }
+		SamplingProfiler& GetSamplingProfiler() { return _samplingProfiler; }
+		GcMonitor& GetGcMonitor() { return _gcMonitor; }
+		TimeAccounting& GetTimeAccounting() { return _timeAccounting; }
+		bool IsHeapSnapshotEnabled() const { return _heapSnapshot.IsEnabled(); }
+		/// Managed objects by type and plugin plus native figures of the module, empty if heap snapshots are disabled.
+		std::string TakeHeapSnapshot();
 
 		template<typename T>
 		MonoArray* CreateArrayT(const std::vector<T>& source, MonoClass* klass);
@@ -123,12 +182,28 @@ namespace monolm {
 		MonoArray* CreateStringArray(const std::vector<T>& source) const;
 		MonoObject* InstantiateClass(MonoClass* klass) const;
 
+		void LoadSymbols(MonoImage* image, fs::path pdbPath);
+		bool ActivateDebugging();
+		bool IsDebuggingActive() const { return _debuggingActive; }
+
+		bool ReleaseDelegate(MonoObject* delegate) { return _thunkPool.Release(delegate); }
+		/// Logs an exception caught in managed code the same way as one raised through the native paths.
+		void ReportException(MonoObject* exc) const { HandleException(exc, nullptr); }
+
+		void Update(float deltaTime);
+		void FixedUpdate(float deltaTime);
+
 	private:
 		bool InitMono(const fs::path& monoPath, std::optional<fs::path> configPath);
 		void ShutdownMono();
 
 		ScriptInstance* CreateScriptInstance(plugify::PluginRef plugin, MonoImage* image);
 
+		plugify::ValueType MonoTypeToValueType(MonoType* type);
+		plugify::ValueType MonoClassToValueType(MonoClass* klass);
+		bool ValidateSignature(plugify::MethodRef method, MonoMethod* monoMethod, std::vector<std::string>& errors);
+		void* CreateDirectEntryPoint(MonoMethod* method, MonoObject* instance);
+
 	private:
 		static void HandleException(MonoObject* exc, void* userData);
 		static void OnLogCallback(const char* logDomain, const char* logLevel, const char* message, mono_bool fatal, void* userData);
@@ -136,6 +211,9 @@ namespace monolm {
 		static void OnPrintErrorCallback(const char* message, mono_bool isStdout);
 
 		static void ExternalCall(plugify::MethodRef method, plugify::MemAddr addr, const plugify::JitCallback::Parameters* params, uint8_t count, const plugify::JitCallback::ReturnValue* ret);
+		static void ExternalCallTracked(plugify::MethodRef method, plugify::MemAddr data, const plugify::JitCallback::Parameters* params, uint8_t count, const plugify::JitCallback::ReturnValue* ret);
+		static void ExternalCallImpl(plugify::MethodRef method, plugify::JitCall::CallingFunc func, ImportMethod* import, const plugify::JitCallback::Parameters* params, uint8_t count, const plugify::JitCallback::ReturnValue* ret);
+		static void InvokeNative(plugify::MethodRef method, plugify::JitCall::CallingFunc func, ImportMethod* import, const uint64_t* params, const plugify::JitCallback::ReturnValue* ret);
 		static void InternalCall(plugify::MethodRef method, plugify::MemAddr data, const plugify::JitCallback::Parameters* params, uint8_t count, const plugify::JitCallback::ReturnValue* ret);
 		static void DelegateCall(plugify::MethodRef method, plugify::MemAddr data, const plugify::JitCallback::Parameters* params, uint8_t count, const plugify::JitCallback::ReturnValue* ret);
 
@@ -152,7 +230,10 @@ namespace monolm {
 		static void* MonoStringToArg(MonoString* source, ArgumentList& args);
 		void* MonoDelegateToArg(MonoDelegate* source, plugify::MethodRef method);
 
-		void CleanupFunctionCache();
+		void FlushStartupTrace();
+		void SaveJitProfiles();
+		void AttachCurrentThread();
+		void PollDebuggingRequest();
 
 	private:
 		std::unique_ptr<MonoDomain, RootDomainDeleter> _rootDomain;
@@ -162,25 +243,88 @@ namespace monolm {
 
 		AssemblyInfo _core;
 		ClassInfo _plugin;
+		LifecycleInfo _lifecycle;
+		MonoMethod* _createEntryPoint{ nullptr };
 
 		std::shared_ptr<plugify::IPlugifyProvider> _provider;
 		std::shared_ptr<asmjit::JitRuntime> _rt;
 
 		std::set<std::string/*, ImportMethod*/> _importMethods;
+		std::vector<std::unique_ptr<ImportMethod>> _trackedImports;
 		std::vector<std::unique_ptr<ExportMethod>> _exportMethods;
 
-		std::unordered_map<void*, Function> _functions;
+		ConcurrentMap<void*, Function> _functions;
 
-		std::map<uint32_t, void*> _cachedFunctions;
-		std::map<void*, uint32_t> _cachedDelegates;
+		/// Native pointer of a primitive delegate, the weak handle tells apart delegates with the same identity hash.
+		struct CachedFunction {
+			uint32_t handle;
+			void* addr;
+		};
+		struct CachedFunctionLease {
+			int32_t identity;
+			uint32_t handle;
+		};
+		static void OnCachedDelegateCollected(void* lease);
+
+		std::unique_ptr<MonoReferenceQueue> _functionReferenceQueue;
+		ConcurrentMap<int32_t, std::vector<CachedFunction>> _cachedFunctions;
+		DelegateThunkPool _thunkPool;
+		ConcurrentMap<void*, uint32_t> _cachedDelegates;
+
+		std::unordered_map<MonoClass*, plugify::ValueType> _classTypes;
 
 		ScriptMap _scripts;
 
+		StartupProfiler _startupProfiler;
+		size_t _startedPlugins{ 0 };
+
+		struct PendingSymbols {
+			MonoImage* image{ nullptr };
+			fs::path path;
+		};
+		std::vector<PendingSymbols> _pendingSymbols;
+		std::atomic<bool> _debuggingActive{ false };
+		std::mutex _debugMutex;
+
+		JitWarmup _jitWarmup;
+		Scheduler _scheduler;
+		CallStats _callStats;
+		mutable AllocStats _allocStats; // recorded from the const Create* helpers
+		PerfMap _perfMap;
+		SamplingProfiler _samplingProfiler;
+		GcMonitor _gcMonitor;
+		TimeAccounting _timeAccounting;
+		CallRecorder _callRecorder;
+		HeapSnapshot _heapSnapshot;
+
 		struct MonoSettings {
 			bool enableDebugging{ false };
 			std::string level;
 			std::string mask;
 			std::vector<std::string> options;
+			std::string startupTrace;
+			bool lazyDebugging{ false };
+			int debugSignal{ 0 };
+			bool jitWarmup{ false };
+			bool detachThreadsOnExit{ false };
+			std::vector<std::string> gcSafeMethods;
+			uint32_t gcSafeThresholdUs{ 0 }; // non-primitive imports slower than this switch to GC safe mode, list primitive ones in gcSafeMethods
+			uint32_t workerThreads{ 0 };
+			bool directExports{ true };
+			bool callStats{ false };
+			bool allocStats{ false };
+			bool perfMap{ false };
+			uint32_t samplingFrequency{ 0 };
+			std::string samplingOutput;
+			bool gcMonitor{ false };
+			std::string gcTrace;
+			bool timeAccounting{ false };
+			TimeBudget timeBudget;
+			std::unordered_map<std::string, TimeBudget> pluginBudgets; // by plugin name, overrides timeBudget
+			bool interruptRunaway{ false }; // abort threads stuck in a call over its budget
+			std::string callTrace; // binary capture of export calls for the replay tool
+			bool heapSnapshot{ false };
+			RuntimeSettings runtime;
 		} _settings;
 
 		friend class ScriptInstance;
@@ -189,4 +333,22 @@ namespace monolm {
 	extern CSharpLanguageModule g_monolm;
 }
 
-extern "C" MONOLM_EXPORT plugify::ILanguageModule* GetLanguageModule();
\ No newline at end of file
+extern "C" MONOLM_EXPORT plugify::ILanguageModule* GetLanguageModule();
+/// Runs jobs posted to the main thread by plugins, call once per tick from the thread which initialized the module.
+extern "C" MONOLM_EXPORT size_t MonoLM_PumpMainThread(uint32_t budgetUs);
+/// Dispatches OnUpdate/OnFixedUpdate to every started plugin in one managed call.
+extern "C" MONOLM_EXPORT void MonoLM_Update(float deltaTime);
+extern "C" MONOLM_EXPORT void MonoLM_FixedUpdate(float deltaTime);
+/// Copies the call statistics report into buffer (always null-terminated), returns the full report length.
+extern "C" MONOLM_EXPORT size_t MonoLM_GetCallStats(char* buffer, size_t size);
+/// Copies the marshalling allocation report into buffer (always null-terminated), returns the full report length.
+extern "C" MONOLM_EXPORT size_t MonoLM_GetAllocStats(char* buffer, size_t size);
+/// Fills summary with garbage collector counters, returns false if the GC monitor is disabled.
+extern "C" MONOLM_EXPORT bool MonoLM_GetGcSummary(monolm::GcSummary* summary);
+/// Writes recent garbage collector pauses as a Chrome trace file.
+extern "C" MONOLM_EXPORT bool MonoLM_WriteGcTrace(const char* path);
+/// Copies the per plugin time report into buffer (always null-terminated), returns the full report length.
+extern "C" MONOLM_EXPORT size_t MonoLM_GetTimeStats(char* buffer, size_t size);
+/// Takes a heap snapshot on the main thread and writes it to path, returns false if heap snapshots are disabled, when called
+/// off the main thread or if the file can not be written.
+extern "C" MONOLM_EXPORT bool MonoLM_WriteHeapSnapshot(const char* path);
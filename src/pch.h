@@ -12,7 +12,15 @@
 #include <functional>
 #include <optional>
 #include <span>
+#include <array>
 #include <fstream>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <thread>
+#include <deque>
+#include <condition_variable>
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -0,0 +1,102 @@
+#pragma once
+
+namespace monolm {
+	/// One instance of T per thread, written without contention by its thread and visited by readers under a per-instance lock.
+	/// Meant for long-lived singletons, each thread caches the slot of the last PerThread<T> it used.
+	template<typename T>
+	class PerThread {
+	public:
+		PerThread() = default;
+		~PerThread() = default;
+
+		PerThread(const PerThread&) = delete;
+		PerThread& operator=(const PerThread&) = delete;
+
+		/// Runs fn(T&) on the instance of the calling thread.
+		template<typename Fn>
+		void Update(Fn&& fn) {
+			Slot& slot = GetSlot();
+			std::lock_guard lock(slot.mutex);
+			fn(slot.value);
+		}
+
+		/// Runs fn(T&) on the instance of the calling thread. If a reader holds the instance or the list of instances,
+		/// wait(std::unique_lock&) must acquire the lock.
+		template<typename Fn, typename Wait>
+		void Update(Fn&& fn, Wait&& wait) {
+			Slot& slot = GetSlot(wait);
+			std::unique_lock lock(slot.mutex, std::try_to_lock);
+			if (!lock.owns_lock()) {
+				wait(lock);
+			}
+			fn(slot.value);
+		}
+
+		/// Runs visit(const T&) for every live thread. Instances of exited threads are handed to retire(T&) once and dropped.
+		template<typename Visit, typename Retire>
+		void Collect(Visit&& visit, Retire&& retire) {
+			std::lock_guard lock(_mutex);
+			std::erase_if(_slots, [&retire](const std::shared_ptr<Slot>& slot) {
+				// Only referenced from here once the owning thread is gone
+				if (slot.use_count() != 1)
+					return false;
+				retire(slot->value);
+				return true;
+			});
+			for (const auto& slot : _slots) {
+				std::lock_guard slotLock(slot->mutex);
+				visit(std::as_const(slot->value));
+			}
+		}
+
+		/// Runs fn(T&) for every live thread.
+		template<typename Fn>
+		void ForEach(Fn&& fn) {
+			std::lock_guard lock(_mutex);
+			for (const auto& slot : _slots) {
+				std::lock_guard slotLock(slot->mutex);
+				fn(slot->value);
+			}
+		}
+
+	private:
+		struct Slot {
+			std::mutex mutex;
+			T value;
+		};
+
+		struct Holder {
+			PerThread* owner{ nullptr };
+			std::shared_ptr<Slot> slot;
+		};
+
+		/// Shared by all GetSlot instantiations, a thread_local inside the template would exist once per wait function.
+		static Holder& GetHolder() {
+			thread_local Holder holder;
+			return holder;
+		}
+
+		Slot& GetSlot() {
+			return GetSlot([](std::unique_lock<std::mutex>& lock) { lock.lock(); });
+		}
+
+		template<typename Wait>
+		Slot& GetSlot(Wait&& wait) {
+			Holder& holder = GetHolder();
+			if (holder.owner != this) {
+				holder.slot = std::make_shared<Slot>();
+				holder.owner = this;
+
+				std::unique_lock lock(_mutex, std::try_to_lock);
+				if (!lock.owns_lock()) {
+					wait(lock);
+				}
+				_slots.push_back(holder.slot);
+			}
+			return *holder.slot;
+		}
+
+		std::mutex _mutex;
+		std::vector<std::shared_ptr<Slot>> _slots;
+	};
+}
@@ -0,0 +1,131 @@
+#include "perf_map.h"
+
+#include <mono/metadata/appdomain.h>
+#include <mono/metadata/class.h>
+#include <mono/metadata/debug-helpers.h>
+#include <mono/metadata/image.h>
+#include <mono/metadata/loader.h>
+#include <mono/metadata/profiler.h>
+#include <mono/utils/mono-publib.h>
+
+#include <cinttypes>
+
+#if !MONOLM_PLATFORM_WINDOWS
+#include <unistd.h>
+#endif
+
+using namespace monolm;
+
+namespace {
+	std::string_view CodeBufferName(MonoProfilerCodeBufferType type) {
+		switch (type) {
+			case MONO_PROFILER_CODE_BUFFER_METHOD: return "method";
+			case MONO_PROFILER_CODE_BUFFER_UNBOX_TRAMPOLINE: return "unbox_trampoline";
+			case MONO_PROFILER_CODE_BUFFER_IMT_TRAMPOLINE: return "imt_trampoline";
+			case MONO_PROFILER_CODE_BUFFER_GENERICS_TRAMPOLINE: return "generics_trampoline";
+			case MONO_PROFILER_CODE_BUFFER_SPECIFIC_TRAMPOLINE: return "specific_trampoline";
+			case MONO_PROFILER_CODE_BUFFER_HELPER: return "helper";
+			case MONO_PROFILER_CODE_BUFFER_DELEGATE_INVOKE: return "delegate_invoke";
+			case MONO_PROFILER_CODE_BUFFER_EXCEPTION_HANDLING: return "exception_handling";
+			default: return "code";
+		}
+	}
+
+	/// Runtime code outside of methods: trampolines, helpers and delegate invoke stubs.
+	void OnCodeBuffer(MonoProfiler* profiler, const mono_byte* buffer, uint64_t size, MonoProfilerCodeBufferType type, const void* data) {
+		auto* self = reinterpret_cast<PerfMap*>(profiler);
+		if (!self->IsOpen())
+			return;
+
+		std::string name = std::format("mono::{}", CodeBufferName(type));
+		if (type == MONO_PROFILER_CODE_BUFFER_SPECIFIC_TRAMPOLINE && data) {
+			std::format_to(std::back_inserter(name), " {}", static_cast<const char*>(data));
+		} else if (type == MONO_PROFILER_CODE_BUFFER_UNBOX_TRAMPOLINE && data) {
+			char* methodName = mono_method_full_name(static_cast<MonoMethod*>(const_cast<void*>(data)), false);
+			std::format_to(std::back_inserter(name), " {}", methodName);
+			mono_free(methodName);
+		}
+		self->Add(buffer, static_cast<size_t>(size), name);
+	}
+}
+
+PerfMap::~PerfMap() {
+	Close();
+}
+
+bool PerfMap::Open(std::weak_ptr<asmjit::JitRuntime> rt) {
+#if MONOLM_PLATFORM_WINDOWS
+	return false;
+#else
+	std::lock_guard lock(_mutex);
+	if (_file)
+		return true;
+
+	// Mono's own --jitmap would truncate this file and write through a separate stream, so managed code is named from profiler events instead
+	_path = std::format("/tmp/perf-{}.map", getpid());
+	_file = std::fopen(_path.c_str(), "w");
+	if (!_file)
+		return false;
+	std::setvbuf(_file, nullptr, _IOLBF, 0);
+
+	_rt = std::move(rt);
+	_open.store(true, std::memory_order_relaxed);
+
+	if (!_profiling) {
+		// Profiler handles live until the runtime shuts down
+		MonoProfilerHandle handle = mono_profiler_create(reinterpret_cast<MonoProfiler*>(this));
+		mono_profiler_set_jit_done_callback(handle, &OnJitDone);
+		mono_profiler_set_jit_code_buffer_callback(handle, &OnCodeBuffer);
+		_profiling = true;
+	}
+	return true;
+#endif
+}
+
+void PerfMap::Close() {
+	std::lock_guard lock(_mutex);
+	if (_file) {
+		std::fclose(_file);
+		_file = nullptr;
+	}
+	_open.store(false, std::memory_order_relaxed);
+}
+
+void PerfMap::AddTrampoline(const void* addr, std::string_view kind, std::string_view name) {
+	if (!IsOpen() || !addr)
+		return;
+
+	auto rt = _rt.lock();
+	if (!rt)
+		return;
+
+	asmjit::JitAllocator::Span span;
+	if (rt->allocator()->query(span, const_cast<void*>(addr)) != asmjit::kErrorOk)
+		return;
+
+	Add(addr, span.size(), std::format("monolm::{} {}", kind, name));
+}
+
+void PerfMap::Add(const void* addr, size_t size, std::string_view name) {
+	if (size == 0)
+		return;
+
+	std::lock_guard lock(_mutex);
+	if (_file) {
+		std::fprintf(_file, "%" PRIxPTR " %zx %.*s\n", reinterpret_cast<uintptr_t>(addr), size, static_cast<int>(name.size()), name.data());
+	}
+}
+
+void PerfMap::OnJitDone(MonoProfiler* profiler, MonoMethod* method, MonoJitInfo* jinfo) {
+	auto* self = reinterpret_cast<PerfMap*>(profiler);
+	if (!self->IsOpen())
+		return;
+
+	// Assembly name tells apart methods of plugins with the same namespaces
+	MonoImage* image = mono_class_get_image(mono_method_get_class(method));
+	char* methodName = mono_method_full_name(method, true);
+	std::string name = std::format("[{}] {}", mono_image_get_name(image), methodName);
+	mono_free(methodName);
+
+	self->Add(mono_jit_info_get_code_start(jinfo), static_cast<size_t>(mono_jit_info_get_code_size(jinfo)), name);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <asmjit/asmjit.h>
+
+#include <cstdio>
+
+extern "C" {
+	typedef struct _MonoMethod MonoMethod;
+	typedef struct _MonoJitInfo MonoJitInfo;
+	typedef struct _MonoProfiler MonoProfiler;
+}
+
+namespace monolm {
+	/// Writes /tmp/perf-<pid>.map, so perf and other Linux profilers can name the trampolines built by asmjit and the
+	/// methods compiled by the Mono JIT instead of showing anonymous addresses.
+	class PerfMap {
+	public:
+		PerfMap() = default;
+		~PerfMap();
+
+		/// Creates the map file and starts naming Mono code, call before mono_jit_init to include runtime trampolines.
+		bool Open(std::weak_ptr<asmjit::JitRuntime> rt);
+		void Close();
+		bool IsOpen() const { return _open.load(std::memory_order_relaxed); }
+		const fs::path& GetPath() const { return _path; }
+
+		/// Names a trampoline generated by asmjit, its size is looked up in the JIT allocator.
+		void AddTrampoline(const void* addr, std::string_view kind, std::string_view name);
+		void Add(const void* addr, size_t size, std::string_view name);
+
+	private:
+		static void OnJitDone(MonoProfiler* profiler, MonoMethod* method, MonoJitInfo* jinfo);
+
+		std::FILE* _file{ nullptr };
+		fs::path _path;
+		std::weak_ptr<asmjit::JitRuntime> _rt;
+		std::mutex _mutex;
+		std::atomic<bool> _open{ false };
+		bool _profiling{ false };
+	};
+}
@@ -0,0 +1,262 @@
+#include "sampling_profiler.h"
+
+#include <mono/metadata/class.h>
+#include <mono/metadata/debug-helpers.h>
+#include <mono/metadata/loader.h>
+#include <mono/metadata/profiler.h>
+
+#include <glaze/glaze.hpp>
+
+using namespace monolm;
+
+namespace {
+	constexpr std::string_view kRuntimeOwner = "[runtime]";
+
+	struct SpeedscopeFrame {
+		std::string name;
+	};
+
+	struct SpeedscopeShared {
+		std::vector<SpeedscopeFrame> frames;
+	};
+
+	struct SpeedscopeProfile {
+		std::string type{ "sampled" };
+		std::string name;
+		std::string unit{ "none" };
+		uint64_t startValue{};
+		uint64_t endValue{};
+		std::vector<std::vector<uint32_t>> samples;
+		std::vector<uint64_t> weights;
+	};
+
+	struct SpeedscopeFile {
+		std::string schema{ "https://www.speedscope.app/file-format-schema.json" };
+		SpeedscopeShared shared;
+		std::vector<SpeedscopeProfile> profiles;
+		std::string name{ "mono-lang-module" };
+		std::string exporter{ "mono-lang-module" };
+	};
+}
+
+template<>
+struct glz::meta<SpeedscopeFile> {
+	using T = SpeedscopeFile;
+	static constexpr auto value = glz::object("$schema", &T::schema, "shared", &T::shared, "profiles", &T::profiles, "name", &T::name, "exporter", &T::exporter);
+};
+
+namespace {
+	struct FrameWalk {
+		MonoMethod** frames;
+		uint32_t capacity;
+		uint32_t depth;
+	};
+
+	/// Runs inside the sampling signal handler, only writes into the preallocated sample.
+	mono_bool OnFrame(MonoMethod* method, MonoDomain* /*domain*/, void* /*baseAddress*/, int /*offset*/, void* data) {
+		auto* walk = static_cast<FrameWalk*>(data);
+		if (method) {
+			walk->frames[walk->depth++] = method;
+		}
+		return walk->depth == walk->capacity;
+	}
+}
+
+SamplingProfiler::~SamplingProfiler() {
+	Stop();
+}
+
+void SamplingProfiler::Enable(uint32_t frequency) {
+	if (_handle || frequency == 0)
+		return;
+
+	_ring = std::make_unique<Sample[]>(kRingSize);
+	_frequency = frequency;
+
+	// Profiler handles live until the runtime shuts down, the sampling thread idles while the mode is none
+	_handle = mono_profiler_create(reinterpret_cast<MonoProfiler*>(this));
+	if (!mono_profiler_enable_sampling(_handle)) {
+		_handle = nullptr;
+		return;
+	}
+	mono_profiler_set_sample_hit_callback(_handle, &OnSampleHit);
+}
+
+bool SamplingProfiler::Start() {
+	std::lock_guard control(_controlMutex);
+	if (!_handle || _running.exchange(true))
+		return false;
+
+	_worker = std::thread(&SamplingProfiler::Run, this);
+	mono_profiler_set_sample_mode(_handle, MONO_PROFILER_SAMPLE_MODE_PROCESS, _frequency);
+	return true;
+}
+
+void SamplingProfiler::Stop() {
+	std::lock_guard control(_controlMutex);
+	if (!_running.exchange(false))
+		return;
+
+	mono_profiler_set_sample_mode(_handle, MONO_PROFILER_SAMPLE_MODE_NONE, _frequency);
+	_condition.notify_one();
+	if (_worker.joinable()) {
+		_worker.join();
+	}
+
+	std::lock_guard lock(_mutex);
+	Drain();
+}
+
+void SamplingProfiler::AddImage(MonoImage* image, std::string owner) {
+	std::lock_guard lock(_mutex);
+	_images.try_emplace(image, std::move(owner));
+}
+
+void SamplingProfiler::OnSampleHit(MonoProfiler* profiler, const uint8_t* /*ip*/, const void* context) {
+	auto* self = reinterpret_cast<SamplingProfiler*>(profiler);
+	if (!self->_running.load(std::memory_order_relaxed))
+		return;
+
+	// Signal handler: no locks and no allocation, a full slot drops the sample
+	Sample& sample = self->_ring[self->_head.fetch_add(1, std::memory_order_relaxed) % kRingSize];
+	uint32_t expected = Sample::Free;
+	if (!sample.state.compare_exchange_strong(expected, Sample::Writing, std::memory_order_acquire)) {
+		self->_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	FrameWalk walk{ sample.frames.data(), static_cast<uint32_t>(kMaxDepth), 0 };
+	mono_stack_walk_async_safe(&OnFrame, const_cast<void*>(context), &walk);
+	sample.depth = walk.depth;
+	sample.state.store(Sample::Ready, std::memory_order_release);
+}
+
+void SamplingProfiler::Run() {
+	std::unique_lock lock(_mutex);
+	while (_running.load(std::memory_order_relaxed)) {
+		Drain();
+		_condition.wait_for(lock, std::chrono::milliseconds(20));
+	}
+}
+
+void SamplingProfiler::Drain() {
+	std::vector<MonoMethod*> frames;
+	for (size_t i = 0; i < kRingSize; ++i) {
+		Sample& sample = _ring[i];
+		if (sample.state.load(std::memory_order_acquire) != Sample::Ready)
+			continue;
+
+		// Threads without managed frames are idle or in native code, they do not belong to any plugin
+		if (sample.depth != 0) {
+			std::string_view owner = kRuntimeOwner;
+			for (uint32_t j = 0; j < sample.depth; ++j) {
+				auto it = _images.find(mono_class_get_image(mono_method_get_class(sample.frames[j])));
+				if (it != _images.end()) {
+					owner = it->second;
+					break;
+				}
+			}
+
+			frames.assign(sample.frames.rbegin() + static_cast<ptrdiff_t>(kMaxDepth - sample.depth), sample.frames.rend());
+			++_stacks[StackKey{ owner, frames }];
+			_sampleCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		sample.state.store(Sample::Free, std::memory_order_release);
+	}
+}
+
+const std::string& SamplingProfiler::GetMethodName(MonoMethod* method) {
+	auto [it, inserted] = _names.try_emplace(method);
+	if (inserted) {
+		char* name = mono_method_full_name(method, false);
+		it->second = name;
+		mono_free(name);
+	}
+	return it->second;
+}
+
+std::string SamplingProfiler::GetCollapsedStacks() {
+	std::lock_guard lock(_mutex);
+	if (_ring) {
+		Drain();
+	}
+
+	std::string result;
+	for (const auto& [key, count] : _stacks) {
+		const auto& [owner, frames] = key;
+		result += owner;
+		for (MonoMethod* method : frames) {
+			result += ';';
+			// Separators of the folded format must not appear inside frame names
+			for (char c : GetMethodName(method)) {
+				result += c == ';' ? ',' : c;
+			}
+		}
+		std::format_to(std::back_inserter(result), " {}\n", count);
+	}
+	return result;
+}
+
+std::string SamplingProfiler::GetSpeedscope() {
+	std::lock_guard lock(_mutex);
+	if (_ring) {
+		Drain();
+	}
+
+	SpeedscopeFile file;
+	std::unordered_map<MonoMethod*, uint32_t> frameIndices;
+	std::map<std::string_view, SpeedscopeProfile> profiles;
+
+	for (const auto& [key, count] : _stacks) {
+		const auto& [owner, frames] = key;
+
+		std::vector<uint32_t> stack;
+		stack.reserve(frames.size());
+		for (MonoMethod* method : frames) {
+			auto [it, inserted] = frameIndices.try_emplace(method, static_cast<uint32_t>(file.shared.frames.size()));
+			if (inserted) {
+				file.shared.frames.push_back({ GetMethodName(method) });
+			}
+			stack.push_back(it->second);
+		}
+
+		SpeedscopeProfile& profile = profiles[owner];
+		profile.samples.push_back(std::move(stack));
+		profile.weights.push_back(count);
+		profile.endValue += count;
+	}
+
+	for (auto& [owner, profile] : profiles) {
+		profile.name = owner;
+		file.profiles.push_back(std::move(profile));
+	}
+
+	std::string buffer;
+	(void) glz::write_json(file, buffer);
+	return buffer;
+}
+
+bool SamplingProfiler::Write(const fs::path& path) {
+	std::string content = path.extension() == ".json" ? GetSpeedscope() : GetCollapsedStacks();
+
+	std::error_code error;
+	if (path.has_parent_path())
+		fs::create_directories(path.parent_path(), error);
+
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if (!ostream.is_open())
+		return false;
+	ostream.write(content.data(), static_cast<std::streamsize>(content.size()));
+	return ostream.good();
+}
+
+void SamplingProfiler::Reset() {
+	std::lock_guard lock(_mutex);
+	if (_ring) {
+		Drain();
+	}
+	_stacks.clear();
+	_sampleCount.store(0, std::memory_order_relaxed);
+	_dropped.store(0, std::memory_order_relaxed);
+}
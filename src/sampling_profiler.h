@@ -0,0 +1,80 @@
+#pragma once
+
+extern "C" {
+	typedef struct _MonoImage MonoImage;
+	typedef struct _MonoMethod MonoMethod;
+	typedef struct _MonoProfiler MonoProfiler;
+	typedef struct _MonoProfilerDesc* MonoProfilerHandle;
+}
+
+namespace monolm {
+	/// Samples managed call stacks of all runtime threads with the Mono sampling profiler and aggregates them per plugin.
+	/// Stacks are captured in the signal handler into a fixed ring and folded into the aggregate by a background thread.
+	class SamplingProfiler {
+	public:
+		SamplingProfiler() = default;
+		~SamplingProfiler();
+
+		/// Registers the profiler, has to be called before mono_jit_init. Sampling only runs between Start and Stop.
+		void Enable(uint32_t frequency);
+		bool IsEnabled() const { return _handle != nullptr; }
+
+		bool Start();
+		void Stop();
+		bool IsRunning() const { return _running.load(std::memory_order_relaxed); }
+
+		/// Samples are attributed to the plugin owning the innermost frame from one of its images.
+		void AddImage(MonoImage* image, std::string owner);
+
+		/// Folded stacks, one "plugin;outer;...;inner count" line per stack, as read by flamegraph.pl and speedscope.
+		std::string GetCollapsedStacks();
+		/// Speedscope file with one sampled profile per plugin.
+		std::string GetSpeedscope();
+		/// Writes speedscope JSON for a .json path, collapsed stacks otherwise.
+		bool Write(const fs::path& path);
+		void Reset();
+
+		uint64_t GetSampleCount() const { return _sampleCount.load(std::memory_order_relaxed); }
+		uint64_t GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr size_t kMaxDepth = 64;
+		static constexpr size_t kRingSize = 2048;
+
+		struct Sample {
+			enum State : uint32_t { Free, Writing, Ready };
+
+			std::atomic<uint32_t> state{ Free };
+			uint32_t depth{};
+			std::array<MonoMethod*, kMaxDepth> frames{}; // innermost first
+		};
+
+		/// Owner plugin and frames, outermost first.
+		using StackKey = std::pair<std::string_view, std::vector<MonoMethod*>>;
+
+		static void OnSampleHit(MonoProfiler* profiler, const uint8_t* ip, const void* context);
+
+		void Run();
+		/// Folds captured samples into the aggregate, requires _mutex.
+		void Drain();
+		/// Resolves and caches the method name, requires _mutex.
+		const std::string& GetMethodName(MonoMethod* method);
+
+		MonoProfilerHandle _handle{ nullptr };
+		uint32_t _frequency{ 0 };
+		std::unique_ptr<Sample[]> _ring;
+		std::atomic<uint64_t> _head{ 0 };
+		std::atomic<uint64_t> _sampleCount{ 0 };
+		std::atomic<uint64_t> _dropped{ 0 };
+
+		std::mutex _mutex;
+		std::unordered_map<MonoImage*, std::string> _images;
+		std::unordered_map<MonoMethod*, std::string> _names;
+		std::map<StackKey, uint64_t> _stacks;
+
+		std::mutex _controlMutex; // serializes Start and Stop, both are reachable from managed code on any thread
+		std::thread _worker;
+		std::condition_variable _condition;
+		std::atomic<bool> _running{ false };
+	};
+}
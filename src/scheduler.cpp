@@ -0,0 +1,160 @@
+#include "scheduler.h"
+
+#include <mono/metadata/object.h>
+#include <mono/metadata/threads.h>
+
+MONO_API void* mono_threads_enter_gc_safe_region(void** stackdata);
+MONO_API void mono_threads_exit_gc_safe_region(void* cookie, void** stackdata);
+
+using namespace monolm;
+
+void Scheduler::Init(MonoDomain* domain, size_t workerCount, ExceptionHandler handler) {
+	_domain = domain;
+	_handler = handler;
+	_mainThread = std::this_thread::get_id();
+	_workerCount = workerCount != 0 ? workerCount : std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+	_stop = false;
+	_mainStopped = false;
+}
+
+void Scheduler::Shutdown() {
+	{
+		std::lock_guard lock(_mutex);
+		_stop = true;
+	}
+	_condition.notify_all();
+
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+
+	for (uint32_t handle : _workerJobs) {
+		mono_gchandle_free(handle);
+	}
+	_workerJobs.clear();
+
+	_mainStopped = true;
+	DiscardMain();
+	for (uint32_t handle : _mainLocal) {
+		mono_gchandle_free(handle);
+	}
+	_mainLocal.clear();
+}
+
+void Scheduler::PostWorker(uint32_t handle) {
+	{
+		std::lock_guard lock(_mutex);
+		if (_stop) {
+			mono_gchandle_free(handle);
+			return;
+		}
+
+		// Workers are started on first use, plugins which never schedule work cost nothing
+		if (_workers.empty()) {
+			_workers.reserve(_workerCount);
+			for (size_t i = 0; i < _workerCount; ++i) {
+				_workers.emplace_back(&Scheduler::RunWorker, this);
+			}
+		}
+
+		_workerJobs.push_back(handle);
+	}
+	_condition.notify_one();
+}
+
+void Scheduler::PostMain(uint32_t handle) {
+	if (_mainStopped) {
+		mono_gchandle_free(handle);
+		return;
+	}
+
+	auto* node = new Node{ _mainHead.load(std::memory_order_relaxed), handle };
+	while (!_mainHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+
+	// Shutdown may have drained the stack between the check and the push, nobody pumps it anymore
+	if (_mainStopped) {
+		DiscardMain();
+	}
+}
+
+void Scheduler::DiscardMain() {
+	Node* node = _mainHead.exchange(nullptr, std::memory_order_acquire);
+	while (node) {
+		mono_gchandle_free(node->handle);
+		delete std::exchange(node, node->next);
+	}
+}
+
+size_t Scheduler::Pump(std::chrono::microseconds budget) {
+	// Producers push onto a stack, reverse it to keep jobs in posting order
+	Node* node = _mainHead.exchange(nullptr, std::memory_order_acquire);
+	Node* reversed = nullptr;
+	while (node) {
+		Node* next = node->next;
+		node->next = reversed;
+		reversed = node;
+		node = next;
+	}
+	while (reversed) {
+		_mainLocal.push_back(reversed->handle);
+		delete std::exchange(reversed, reversed->next);
+	}
+
+	auto deadline = std::chrono::steady_clock::now() + budget;
+
+	size_t count = 0;
+	while (!_mainLocal.empty()) {
+		uint32_t handle = _mainLocal.front();
+		_mainLocal.pop_front();
+		Invoke(handle);
+		++count;
+
+		if (budget.count() != 0 && std::chrono::steady_clock::now() >= deadline)
+			break;
+	}
+	return count;
+}
+
+void Scheduler::RunWorker() {
+	MonoThread* thread = mono_thread_attach(_domain);
+
+	while (true) {
+		uint32_t handle = 0;
+		{
+			// Waiting in GC safe mode, an idle worker never holds up a collection
+			void* stackdata[2]{};
+			void* cookie = mono_threads_enter_gc_safe_region(stackdata);
+
+			std::unique_lock lock(_mutex);
+			_condition.wait(lock, [this] { return _stop || !_workerJobs.empty(); });
+			bool stop = _stop;
+			if (!stop) {
+				handle = _workerJobs.front();
+				_workerJobs.pop_front();
+			}
+			lock.unlock();
+
+			mono_threads_exit_gc_safe_region(cookie, stackdata);
+
+			if (stop)
+				break;
+		}
+
+		Invoke(handle);
+	}
+
+	mono_thread_detach(thread);
+}
+
+void Scheduler::Invoke(uint32_t handle) const {
+	MonoObject* job = mono_gchandle_get_target(handle);
+	if (job) {
+		MonoObject* exception = nullptr;
+		mono_runtime_delegate_invoke(job, nullptr, &exception);
+		if (exception) {
+			_handler(exception, nullptr);
+		}
+	}
+	mono_gchandle_free(handle);
+}
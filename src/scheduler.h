@@ -0,0 +1,58 @@
+#pragma once
+
+extern "C" {
+	typedef struct _MonoDomain MonoDomain;
+	typedef struct _MonoObject MonoObject;
+}
+
+namespace monolm {
+	/// Runs managed Action delegates on an attached worker pool or on the main thread when the host pumps the queue.
+	class Scheduler {
+	public:
+		using ExceptionHandler = void(*)(MonoObject* exc, void* userData);
+
+		Scheduler() = default;
+		~Scheduler() = default;
+
+		void Init(MonoDomain* domain, size_t workerCount, ExceptionHandler handler);
+		void Shutdown();
+
+		/// Takes ownership of a strong gchandle to the job delegate.
+		void PostWorker(uint32_t handle);
+		/// Takes ownership of a strong gchandle to the job delegate, safe to call from any thread. Jobs posted after
+		/// Shutdown are dropped.
+		void PostMain(uint32_t handle);
+
+		/// Runs queued main thread jobs until the queue is empty or the budget is spent, returns the number of jobs run.
+		size_t Pump(std::chrono::microseconds budget);
+
+		bool IsMainThread() const { return std::this_thread::get_id() == _mainThread; }
+		size_t GetWorkerCount() const { return _workerCount; }
+
+	private:
+		void RunWorker();
+		void Invoke(uint32_t handle) const;
+		void DiscardMain();
+
+		// Intrusive node of the lock-free multi producer stack
+		struct Node {
+			Node* next;
+			uint32_t handle;
+		};
+
+		MonoDomain* _domain{ nullptr };
+		ExceptionHandler _handler{ nullptr };
+		std::thread::id _mainThread;
+
+		std::atomic<Node*> _mainHead{ nullptr };
+		std::atomic<bool> _mainStopped{ false };
+		std::deque<uint32_t> _mainLocal;
+
+		size_t _workerCount{ 0 };
+		std::vector<std::thread> _workers;
+		std::deque<uint32_t> _workerJobs;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		bool _stop{ false };
+	};
+}
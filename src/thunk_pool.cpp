@@ -0,0 +1,195 @@
+#include "thunk_pool.h"
+
+#include <mono/metadata/mono-gc.h>
+#include <mono/metadata/object.h>
+
+using namespace monolm;
+using namespace plugify;
+
+namespace {
+	void AppendSignature(std::string& key, PropertyRef prop);
+
+	/// Thunks are interchangeable when the whole signature matches, including nested function prototypes.
+	void AppendSignature(std::string& key, MethodRef method) {
+		key += '(';
+		AppendSignature(key, method.GetReturnType());
+		for (const auto& param : method.GetParamTypes()) {
+			key += ',';
+			AppendSignature(key, param);
+		}
+		key += ')';
+	}
+
+	void AppendSignature(std::string& key, PropertyRef prop) {
+		std::format_to(std::back_inserter(key), "{}", static_cast<int>(prop.GetType()));
+		if (prop.IsReference()) {
+			key += '&';
+		}
+		if (prop.GetType() == ValueType::Function) {
+			auto prototype = prop.GetPrototype();
+			if (prototype.has_value()) {
+				AppendSignature(key, *prototype);
+			}
+		}
+	}
+}
+
+void DelegateThunkPool::Init(std::weak_ptr<asmjit::JitRuntime> rt, JitCallback::CallbackHandler handler, PerfMap* perfMap) {
+	std::lock_guard lock(_mutex);
+	_slots.clear();
+	_closed = false;
+	_rt = std::move(rt);
+	_handler = handler;
+	_perfMap = perfMap;
+	_queue = mono_gc_reference_queue_new(&OnDelegateCollected);
+}
+
+void DelegateThunkPool::Shutdown() {
+	if (_queue) {
+		mono_gc_reference_queue_free(_queue);
+		_queue = nullptr;
+	}
+
+	// Slots stay allocated, the runtime still reports pending leases while the domain unloads
+	std::lock_guard lock(_mutex);
+	for (const auto& slot : _slots) {
+		if (uint32_t handle = slot->handle.exchange(0)) {
+			mono_gchandle_free(handle);
+		}
+	}
+	_active.clear();
+	_free.clear();
+	_closed = true;
+}
+
+void* DelegateThunkPool::Acquire(MonoObject* delegate, MethodRef method, std::string& error) {
+	int32_t identity = mono_object_hash(delegate);
+
+	std::lock_guard lock(_mutex);
+	if (_closed)
+		return nullptr;
+
+	if (Slot* slot = FindActive(delegate, identity))
+		return slot->addr;
+
+	std::string key;
+	AppendSignature(key, method);
+
+	auto it = _free.find(key);
+	if (it == _free.end()) {
+		it = _free.emplace(std::move(key), std::vector<Slot*>{}).first;
+	}
+	auto& [signature, freeSlots] = *it;
+
+	Slot* slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		auto newSlot = std::make_unique<Slot>(_rt);
+		MemAddr addr = newSlot->callback.GetJitFunc(method, _handler, newSlot.get());
+		if (!addr) {
+			error = newSlot->callback.GetError();
+			return nullptr;
+		}
+		newSlot->addr = addr;
+		newSlot->signature = &signature;
+		if (_perfMap && _perfMap->IsOpen()) {
+			_perfMap->AddTrampoline(addr, "delegate", method.GetName());
+		}
+		slot = _slots.emplace_back(std::move(newSlot)).get();
+	}
+
+	slot->handle = mono_gchandle_new_weakref(delegate, false);
+	slot->identity = identity;
+	slot->account = nullptr;
+	slot->accountResolved = false;
+	slot->bound.store(true, std::memory_order_release);
+	_active[identity].push_back(slot);
+
+	// Generation tells apart leases of earlier owners once the slot is reused
+	mono_gc_reference_queue_add(_queue, delegate, new Lease{ this, slot, slot->generation });
+
+	return slot->addr;
+}
+
+bool DelegateThunkPool::Release(MonoObject* delegate) {
+	int32_t identity = mono_object_hash(delegate);
+
+	std::lock_guard lock(_mutex);
+	Slot* slot = FindActive(delegate, identity);
+	if (!slot)
+		return false;
+
+	// Native code may still hold the address, it is only handed out again once the delegate is collected
+	Unbind(slot);
+	slot->parked = true;
+	return true;
+}
+
+void DelegateThunkPool::Reclaim(Slot* slot, uint32_t generation) {
+	if (_closed || slot->generation != generation)
+		return;
+
+	if (slot->parked) {
+		slot->parked = false;
+	} else {
+		Unbind(slot);
+	}
+
+	// The delegate is gone, no call can resolve the handle anymore
+	if (uint32_t handle = slot->handle.exchange(0)) {
+		mono_gchandle_free(handle);
+	}
+
+	++slot->generation;
+	_free[*slot->signature].push_back(slot);
+}
+
+void DelegateThunkPool::Unbind(Slot* slot) {
+	slot->bound.store(false, std::memory_order_release);
+
+	auto it = _active.find(slot->identity);
+	if (it != _active.end()) {
+		auto& slots = std::get<std::vector<Slot*>>(*it);
+		std::erase(slots, slot);
+		if (slots.empty()) {
+			_active.erase(it);
+		}
+	}
+}
+
+DelegateThunkPool::Slot* DelegateThunkPool::FindActive(MonoObject* delegate, int32_t identity) const {
+	auto it = _active.find(identity);
+	if (it == _active.end())
+		return nullptr;
+
+	for (Slot* slot : std::get<std::vector<Slot*>>(*it)) {
+		if (mono_gchandle_get_target(slot->handle) == delegate)
+			return slot;
+	}
+	return nullptr;
+}
+
+void DelegateThunkPool::OnDelegateCollected(void* userData) {
+	auto* lease = static_cast<Lease*>(userData);
+	{
+		std::lock_guard lock(lease->pool->_mutex);
+		lease->pool->Reclaim(lease->slot, lease->generation);
+	}
+	delete lease;
+}
+
+size_t DelegateThunkPool::GetSlotCount() const {
+	std::lock_guard lock(_mutex);
+	return _slots.size();
+}
+
+size_t DelegateThunkPool::GetFreeCount() const {
+	std::lock_guard lock(_mutex);
+	size_t count = 0;
+	for (const auto& [_, slots] : _free) {
+		count += slots.size();
+	}
+	return count;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <plugify/jit/callback.h>
+#include <plugify/method.h>
+
+#include "perf_map.h"
+
+extern "C" {
+	typedef struct _MonoObject MonoObject;
+	typedef struct _MonoReferenceQueue MonoReferenceQueue;
+}
+
+namespace monolm {
+	struct TimeAccount;
+
+	/// Recycles JIT-compiled delegate thunks per signature once the owning delegate is collected. Explicitly released
+	/// thunks stay parked until then, so a stale native pointer keeps hitting an unbound slot instead of a new delegate.
+	class DelegateThunkPool {
+	public:
+		/// Code slot passed as user data to the callback handler, bound to one delegate at a time.
+		struct Slot {
+			explicit Slot(std::weak_ptr<asmjit::JitRuntime> rt) : callback(std::move(rt)) {}
+
+			plugify::JitCallback callback;
+			void* addr{ nullptr };
+			// Weak handle of the delegate, kept until it is collected so a racing call never reads a reused handle
+			std::atomic<uint32_t> handle{ 0 };
+			std::atomic<bool> bound{ false }; // cleared by Release, calls log an error instead of reaching the delegate
+			uint32_t generation{ 0 };
+			bool parked{ false }; // released, waiting for the delegate to be collected
+			int32_t identity{ 0 };
+			const std::string* signature{ nullptr };
+			// Plugin owning the bound delegate, resolved on the first call of each lease
+			std::atomic<TimeAccount*> account{ nullptr };
+			std::atomic<bool> accountResolved{ false };
+		};
+
+		DelegateThunkPool() = default;
+		~DelegateThunkPool() = default;
+
+		/// Slots are named in the perf map if one is given, after the first delegate type bound to them.
+		void Init(std::weak_ptr<asmjit::JitRuntime> rt, plugify::JitCallback::CallbackHandler handler, PerfMap* perfMap = nullptr);
+		void Shutdown();
+
+		/// Returns the thunk bound to the delegate, reusing a free slot of the same signature if possible.
+		void* Acquire(MonoObject* delegate, plugify::MethodRef method, std::string& error);
+		/// Unbinds the delegate from its thunk, calls through the thunk log an error until the delegate is collected.
+		bool Release(MonoObject* delegate);
+
+		size_t GetSlotCount() const;
+		size_t GetFreeCount() const;
+
+	private:
+		struct Lease {
+			DelegateThunkPool* pool;
+			Slot* slot;
+			uint32_t generation;
+		};
+
+		void Unbind(Slot* slot);
+		void Reclaim(Slot* slot, uint32_t generation);
+		Slot* FindActive(MonoObject* delegate, int32_t identity) const;
+
+		static void OnDelegateCollected(void* lease);
+
+		std::weak_ptr<asmjit::JitRuntime> _rt;
+		plugify::JitCallback::CallbackHandler _handler{ nullptr };
+		PerfMap* _perfMap{ nullptr };
+		MonoReferenceQueue* _queue{ nullptr };
+
+		std::vector<std::unique_ptr<Slot>> _slots;
+		std::unordered_map<std::string, std::vector<Slot*>> _free;
+		std::unordered_map<int32_t, std::vector<Slot*>> _active;
+		bool _closed{ false };
+		mutable std::mutex _mutex;
+	};
+}
@@ -0,0 +1,381 @@
+#include "time_accounting.h"
+
+#include <mono/metadata/debug-helpers.h>
+#include <mono/metadata/threads.h>
+
+#include <algorithm>
+
+#if !MONOLM_PLATFORM_WINDOWS
+#include <csignal>
+#include <cerrno>
+#endif
+
+MONO_API void* mono_threads_enter_gc_safe_region(void** stackdata);
+MONO_API void mono_threads_exit_gc_safe_region(void* cookie, void** stackdata);
+
+using namespace monolm;
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::chrono::milliseconds kWatchdogInterval{ 10 };
+	constexpr size_t kCollectInterval = 100; // watchdog iterations between retiring the state of exited threads
+	constexpr std::string_view kKindNames[] = { "export", "delegate", "lifecycle" };
+
+	/// The watchdog holds the slot of a thread while it captures its stack and aborts it, so a thread waiting for its
+	/// own slot has to be suspendable by the runtime meanwhile.
+	void WaitGcSafe(std::unique_lock<std::mutex>& lock) {
+		void* stackdata[2]{};
+		void* cookie = mono_threads_enter_gc_safe_region(stackdata);
+		lock.lock();
+		mono_threads_exit_gc_safe_region(cookie, stackdata);
+	}
+
+#if !MONOLM_PLATFORM_WINDOWS
+	constexpr size_t kMaxStackDepth = 64;
+	constexpr std::chrono::milliseconds kStackTimeout{ 100 };
+
+	struct StackCapture {
+		std::array<MonoMethod*, kMaxStackDepth> frames{};
+		uint32_t depth{ 0 };
+		std::atomic<bool> done{ false };
+	};
+
+	// Requested by the watchdog one at a time, taken by the signal handler on the overrunning thread
+	std::atomic<StackCapture*> g_capture{ nullptr };
+	int g_stackSignal = 0;
+
+	/// Runs inside the stack signal handler, only writes into the preallocated capture.
+	mono_bool OnStackFrame(MonoMethod* method, MonoDomain* /*domain*/, void* /*baseAddress*/, int /*offset*/, void* data) {
+		auto* capture = static_cast<StackCapture*>(data);
+		if (method) {
+			capture->frames[capture->depth++] = method;
+		}
+		return capture->depth == capture->frames.size();
+	}
+
+	void OnStackSignal(int /*signal*/, siginfo_t* /*info*/, void* context) {
+		StackCapture* capture = g_capture.exchange(nullptr, std::memory_order_acq_rel);
+		if (!capture)
+			return;
+		int error = errno;
+		mono_stack_walk_async_safe(&OnStackFrame, context, capture);
+		capture->done.store(true, std::memory_order_release);
+		errno = error;
+	}
+
+	/// Installs the stack handler on the highest real-time signal without a handler, returns 0 if none is free.
+	int InstallStackSignal() {
+		for (int signal = SIGRTMAX; signal >= SIGRTMIN; --signal) {
+			struct sigaction current{};
+			if (sigaction(signal, nullptr, &current) != 0 || (current.sa_flags & SA_SIGINFO) || current.sa_handler != SIG_DFL)
+				continue;
+
+			struct sigaction action{};
+			action.sa_sigaction = &OnStackSignal;
+			action.sa_flags = SA_SIGINFO | SA_RESTART;
+			sigemptyset(&action.sa_mask);
+			if (sigaction(signal, &action, nullptr) == 0)
+				return signal;
+		}
+		return 0;
+	}
+#endif
+
+	uint64_t ToNs(Clock::duration duration) {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	}
+
+	void AtomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+		uint64_t current = target.load(std::memory_order_relaxed);
+		while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+	}
+}
+
+TimeAccounting::~TimeAccounting() {
+	Disable();
+}
+
+void TimeAccounting::Enable(TimeBudget defaults, bool interrupt, Logger logger) {
+	if (_enabled.exchange(true))
+		return;
+
+	_defaults = defaults;
+	_interrupt = interrupt;
+	_logger = std::move(logger);
+	_stop = false;
+#if !MONOLM_PLATFORM_WINDOWS
+	// Stays installed after Disable, it ignores the signal without a pending capture
+	if (!g_stackSignal) {
+		g_stackSignal = InstallStackSignal();
+	}
+#endif
+	_watchdog = std::thread(&TimeAccounting::RunWatchdog, this);
+}
+
+void TimeAccounting::Disable() {
+	if (!_enabled.exchange(false))
+		return;
+
+	{
+		std::lock_guard lock(_watchdogMutex);
+		_stop = true;
+	}
+	_watchdogCondition.notify_one();
+	if (_watchdog.joinable()) {
+		_watchdog.join();
+	}
+
+	std::lock_guard lock(_accountsMutex);
+	_images.clear();
+	_accounts.clear();
+}
+
+TimeAccount* TimeAccounting::AddAccount(MonoImage* image, std::string name, std::optional<TimeBudget> budget) {
+	auto account = std::make_unique<TimeAccount>();
+	account->name = std::move(name);
+	account->budget = budget.value_or(_defaults);
+
+	std::lock_guard lock(_accountsMutex);
+	TimeAccount* result = _accounts.emplace_back(std::move(account)).get();
+	_images.insert_or_assign(image, result);
+	return result;
+}
+
+TimeAccount* TimeAccounting::FindAccount(MonoImage* image) const {
+	std::lock_guard lock(_accountsMutex);
+	auto it = _images.find(image);
+	return it != _images.end() ? it->second : nullptr;
+}
+
+void TimeAccounting::Enter(TimeAccount* account, TimeKind kind, std::string_view name, bool interruptible) {
+	_threads.Update([&](ThreadState& state) {
+		if (!state.thread) {
+			state.thread = mono_thread_current();
+#if !MONOLM_PLATFORM_WINDOWS
+			state.native = pthread_self();
+#endif
+		}
+		state.frames.push_back(Frame{ account, kind, name, Clock::now(), 0, interruptible });
+	}, WaitGcSafe);
+}
+
+bool TimeAccounting::Returned() {
+	bool aborted = false;
+	_threads.Update([&](ThreadState& state) {
+		Frame& frame = state.frames.back();
+		frame.managed = false;
+		aborted = frame.aborted;
+	}, WaitGcSafe);
+	return aborted;
+}
+
+void TimeAccounting::Leave() {
+	auto end = Clock::now();
+
+	Frame frame;
+	_threads.Update([&](ThreadState& state) {
+		frame = state.frames.back();
+		state.frames.pop_back();
+
+		// Time of nested calls belongs to their own plugins
+		if (!state.frames.empty()) {
+			state.frames.back().childNs += ToNs(end - frame.start);
+		}
+	}, WaitGcSafe);
+
+	// Frames without an account only keep nested plugin time out of their caller
+	if (!frame.account)
+		return;
+
+	TimeAccount& account = *frame.account;
+	uint64_t totalNs = ToNs(end - frame.start);
+	uint64_t selfNs = totalNs - std::min(frame.childNs, totalNs);
+	auto kind = static_cast<size_t>(frame.kind);
+	account.ns[kind].fetch_add(selfNs, std::memory_order_relaxed);
+	account.calls[kind].fetch_add(1, std::memory_order_relaxed);
+	account.tickNs.fetch_add(selfNs, std::memory_order_relaxed);
+
+	uint32_t callUs = account.budget.callUs;
+	if (callUs != 0 && totalNs > uint64_t{ callUs } * 1000) {
+		account.callOverruns.fetch_add(1, std::memory_order_relaxed);
+		// Calls caught by the watchdog were already reported with their stack
+		if (!frame.reported) {
+			Warn(account, std::format("{} '{}' of '{}' took {} us, budget {} us",
+									  kKindNames[kind], frame.name, account.name, totalNs / 1000, callUs));
+		}
+	}
+}
+
+void TimeAccounting::EndTick() {
+	std::lock_guard lock(_accountsMutex);
+	for (const auto& account : _accounts) {
+		uint64_t tickNs = account->tickNs.exchange(0, std::memory_order_relaxed);
+		account->lastTickNs.store(tickNs, std::memory_order_relaxed);
+		AtomicMax(account->maxTickNs, tickNs);
+
+		uint32_t tickUs = account->budget.tickUs;
+		if (tickUs != 0 && tickNs > uint64_t{ tickUs } * 1000) {
+			account->tickOverruns.fetch_add(1, std::memory_order_relaxed);
+			Warn(*account, std::format("'{}' spent {} us in managed code this tick, budget {} us", account->name, tickNs / 1000, tickUs));
+		}
+	}
+}
+
+void TimeAccounting::Warn(TimeAccount& account, std::string message) {
+	auto now = static_cast<int64_t>(ToNs(Clock::now().time_since_epoch()));
+	int64_t last = account.lastWarning.load(std::memory_order_relaxed);
+	if (now - last < 1'000'000'000 || !account.lastWarning.compare_exchange_strong(last, now, std::memory_order_relaxed))
+		return;
+	if (_logger) {
+		_logger(message);
+	}
+}
+
+void TimeAccounting::RunWatchdog() {
+	// Tools threads are attached to the runtime but never suspended by it or listed in thread dumps
+	mono_threads_attach_tools_thread();
+
+	struct Overrun {
+		TimeAccount* account;
+		TimeKind kind;
+		std::string_view name;
+		uint64_t elapsedUs;
+		bool aborted;
+		std::string stack;
+	};
+	std::vector<Overrun> overruns;
+	size_t iteration = 0;
+
+	std::unique_lock lock(_watchdogMutex);
+	while (!_watchdogCondition.wait_for(lock, kWatchdogInterval, [this] { return _stop.load(); })) {
+		if (++iteration % kCollectInterval == 0) {
+			_threads.Collect([](const ThreadState&) {}, [](ThreadState&) {});
+		}
+
+		auto now = Clock::now();
+
+		overruns.clear();
+		_threads.ForEach([&](ThreadState& state) {
+			std::optional<std::string> stack;
+			for (size_t i = 0; i < state.frames.size(); ++i) {
+				Frame& frame = state.frames[i];
+				if (!frame.account || frame.reported)
+					continue;
+				uint32_t callUs = frame.account->budget.callUs;
+				if (callUs == 0)
+					continue;
+				uint64_t elapsedUs = ToNs(now - frame.start) / 1000;
+				if (elapsedUs <= callUs)
+					continue;
+
+				frame.reported = true;
+				if (!stack) {
+					stack = CaptureStack(state);
+				}
+
+				// Only the innermost frame while its managed call runs, never a caller or a nested call. A thread which
+				// returned meanwhile blocks on its slot in Returned or Leave and learns about the abort there.
+				bool abort = _interrupt && frame.interruptible && frame.managed && state.thread && i + 1 == state.frames.size();
+				if (abort) {
+					// Raises ThreadAbortException at the next safepoint, the call fails like any throwing export
+					frame.aborted = true;
+					mono_thread_stop(state.thread);
+				}
+				overruns.push_back(Overrun{ frame.account, frame.kind, frame.name, elapsedUs, abort, *stack });
+			}
+		});
+
+		for (const Overrun& overrun : overruns) {
+			TimeAccount& account = *overrun.account;
+			if (_logger) {
+				_logger(std::format("{} '{}' of '{}' is running for {} us, budget {} us{}{}",
+									kKindNames[static_cast<size_t>(overrun.kind)], overrun.name, account.name, overrun.elapsedUs, account.budget.callUs,
+									overrun.aborted ? ", aborting the thread" : "", overrun.stack));
+			}
+		}
+	}
+}
+
+std::string TimeAccounting::CaptureStack([[maybe_unused]] const ThreadState& state) {
+#if MONOLM_PLATFORM_WINDOWS
+	return {};
+#else
+	if (!g_stackSignal || !state.native)
+		return {};
+
+	// The overrunning thread walks its own stack in the signal handler, like samples of the sampling profiler
+	StackCapture capture;
+	g_capture.store(&capture, std::memory_order_release);
+	if (pthread_kill(state.native, g_stackSignal) == 0) {
+		auto deadline = Clock::now() + kStackTimeout;
+		while (!capture.done.load(std::memory_order_acquire) && Clock::now() < deadline) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	if (g_capture.exchange(nullptr, std::memory_order_acq_rel)) {
+		// Signal not delivered in time, for example while the thread is suspended by a collection
+		return std::string{ "\n    (managed stack not available)" };
+	}
+	// A handler which took the capture finishes it before it goes out of scope
+	while (!capture.done.load(std::memory_order_acquire)) {
+		std::this_thread::yield();
+	}
+
+	std::string stack;
+	for (uint32_t i = 0; i < capture.depth; ++i) {
+		char* name = mono_method_full_name(capture.frames[i], true);
+		std::format_to(std::back_inserter(stack), "\n    at {}", name);
+		mono_free(name);
+	}
+	return stack;
+#endif
+}
+
+std::string TimeAccounting::Report() const {
+	struct Row {
+		const TimeAccount* account;
+		uint64_t totalNs;
+	};
+
+	std::lock_guard lock(_accountsMutex);
+	std::vector<Row> rows;
+	rows.reserve(_accounts.size());
+	for (const auto& account : _accounts) {
+		uint64_t totalNs = 0;
+		for (const auto& ns : account->ns) {
+			totalNs += ns.load(std::memory_order_relaxed);
+		}
+		rows.push_back(Row{ account.get(), totalNs });
+	}
+	std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+		return a.totalNs > b.totalNs;
+	});
+
+	std::string report = std::format("{:>12} {:>12} {:>12} {:>12} {:>10} {:>10} {:>8} {:>8}  {}\n",
+									 "total ms", "export ms", "delegate ms", "lifecycle ms", "tick us", "max tick", "call!", "tick!", "plugin");
+	for (const Row& row : rows) {
+		const TimeAccount& a = *row.account;
+		auto ms = [](const std::atomic<uint64_t>& ns) { return static_cast<double>(ns.load(std::memory_order_relaxed)) / 1e6; };
+		std::format_to(std::back_inserter(report), "{:>12.3f} {:>12.3f} {:>12.3f} {:>12.3f} {:>10} {:>10} {:>8} {:>8}  {}\n",
+					   static_cast<double>(row.totalNs) / 1e6, ms(a.ns[0]), ms(a.ns[1]), ms(a.ns[2]),
+					   a.lastTickNs.load(std::memory_order_relaxed) / 1000, a.maxTickNs.load(std::memory_order_relaxed) / 1000,
+					   a.callOverruns.load(std::memory_order_relaxed), a.tickOverruns.load(std::memory_order_relaxed), a.name);
+	}
+	return report;
+}
+
+void TimeAccounting::Reset() {
+	std::lock_guard lock(_accountsMutex);
+	for (const auto& account : _accounts) {
+		for (size_t i = 0; i < TimeAccount::kKinds; ++i) {
+			account->ns[i].store(0, std::memory_order_relaxed);
+			account->calls[i].store(0, std::memory_order_relaxed);
+		}
+		account->tickNs.store(0, std::memory_order_relaxed);
+		account->lastTickNs.store(0, std::memory_order_relaxed);
+		account->maxTickNs.store(0, std::memory_order_relaxed);
+		account->callOverruns.store(0, std::memory_order_relaxed);
+		account->tickOverruns.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "per_thread.h"
+
+#if !MONOLM_PLATFORM_WINDOWS
+#include <pthread.h>
+#endif
+
+extern "C" {
+	typedef struct _MonoImage MonoImage;
+	typedef struct _MonoThread MonoThread;
+}
+
+namespace monolm {
+	enum class TimeKind : uint8_t {
+		Export,    // native -> C# exported method
+		Delegate,  // native -> C# delegate
+		Lifecycle, // OnStart, OnEnd and the per tick callbacks
+	};
+
+	struct TimeBudget {
+		uint32_t callUs{ 0 }; // a single managed call, 0 disables the check
+		uint32_t tickUs{ 0 }; // all calls of the plugin between two ticks
+	};
+
+	/// Time spent in the managed code of one plugin, excluding calls into other plugins.
+	struct TimeAccount {
+		static constexpr size_t kKinds = 3;
+
+		std::string name;
+		TimeBudget budget;
+
+		std::array<std::atomic<uint64_t>, kKinds> ns{};
+		std::array<std::atomic<uint64_t>, kKinds> calls{};
+		std::atomic<uint64_t> tickNs{ 0 };
+		std::atomic<uint64_t> lastTickNs{ 0 };
+		std::atomic<uint64_t> maxTickNs{ 0 };
+		std::atomic<uint64_t> callOverruns{ 0 };
+		std::atomic<uint64_t> tickOverruns{ 0 };
+		std::atomic<int64_t> lastWarning{ 0 }; // steady clock ns, limits warnings to one per second
+	};
+
+	/// Attributes managed time to the owning plugin and enforces call and tick budgets. A watchdog thread reports calls
+	/// which exceed their budget while still running, with the managed stack of the thread and optionally a thread abort.
+	class TimeAccounting {
+	public:
+		using Logger = std::function<void(const std::string& message)>;
+
+		TimeAccounting() = default;
+		~TimeAccounting();
+
+		void Enable(TimeBudget defaults, bool interrupt, Logger logger);
+		void Disable();
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		/// Accounts live until Disable, so pointers can be kept next to exports and delegate thunks.
+		TimeAccount* AddAccount(MonoImage* image, std::string name, std::optional<TimeBudget> budget);
+		TimeAccount* FindAccount(MonoImage* image) const;
+
+		/// Only interruptible frames, the budgeted plugin call itself, are aborted by the watchdog.
+		void Enter(TimeAccount* account, TimeKind kind, std::string_view name, bool interruptible = false);
+		/// Marks the managed call of the current frame as returned, the watchdog no longer aborts it. True if the watchdog
+		/// aborted the call before, the abort may still be pending on the thread and has to be reset.
+		bool Returned();
+		void Leave();
+
+		/// Closes the current tick, plugins above their tick budget are reported.
+		void EndTick();
+
+		/// Text table of all plugins, sorted by total time.
+		std::string Report() const;
+		/// Clears the counters of all accounts.
+		void Reset();
+
+		/// Measures one managed call of a plugin, does nothing without an account.
+		class Scope {
+		public:
+			Scope(TimeAccounting& accounting, TimeAccount* account, TimeKind kind, std::string_view name, bool interruptible = false)
+				: _accounting{account && accounting.IsEnabled() ? &accounting : nullptr} {
+				if (_accounting) {
+					_accounting->Enter(account, kind, name, interruptible);
+				}
+			}
+
+			/// See TimeAccounting::Returned.
+			bool Returned() {
+				return _accounting && _accounting->Returned();
+			}
+
+			~Scope() {
+				if (_accounting) {
+					_accounting->Leave();
+				}
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			TimeAccounting* _accounting;
+		};
+
+	private:
+		struct Frame {
+			TimeAccount* account;
+			TimeKind kind;
+			std::string_view name;
+			std::chrono::steady_clock::time_point start;
+			uint64_t childNs{};
+			bool interruptible{ false };
+			bool managed{ true }; // still inside the managed call, cleared by Returned and Leave
+			bool aborted{ false };
+			bool reported{ false };
+		};
+
+		struct ThreadState {
+			std::vector<Frame> frames;
+			MonoThread* thread{ nullptr };
+#if !MONOLM_PLATFORM_WINDOWS
+			pthread_t native{};
+#endif
+		};
+
+		void RunWatchdog();
+		std::string CaptureStack(const ThreadState& state);
+		void Warn(TimeAccount& account, std::string message);
+
+		std::atomic<bool> _enabled{ false };
+		TimeBudget _defaults;
+		bool _interrupt{ false };
+		Logger _logger;
+
+		PerThread<ThreadState> _threads;
+
+		mutable std::mutex _accountsMutex;
+		std::vector<std::unique_ptr<TimeAccount>> _accounts;
+		std::unordered_map<MonoImage*, TimeAccount*> _images;
+
+		std::thread _watchdog;
+		std::mutex _watchdogMutex;
+		std::condition_variable _watchdogCondition;
+		std::atomic<bool> _stop{ false };
+	};
+}
@@ -0,0 +1,79 @@
+#include "trace.h"
+
+#include <glaze/glaze.hpp>
+
+using namespace monolm;
+
+bool monolm::WriteTraceFile(const fs::path& path, std::vector<TraceEvent> events) {
+	std::error_code error;
+	if (path.has_parent_path())
+		fs::create_directories(path.parent_path(), error);
+
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if (!ostream.is_open())
+		return false;
+
+	std::string buffer;
+	(void) glz::write_json(TraceFile{ std::move(events) }, buffer);
+	ostream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	return ostream.good();
+}
+
+uint64_t monolm::GetTraceThreadId() {
+	static std::atomic<uint64_t> counter{ 0 };
+	thread_local uint64_t id = ++counter;
+	return id;
+}
+
+void StartupProfiler::Enable(fs::path outputPath) {
+	std::lock_guard lock(_mutex);
+	_outputPath = std::move(outputPath);
+	_origin = TraceClock::now();
+	_events.clear();
+	_enabled = true;
+}
+
+void StartupProfiler::Disable() {
+	std::lock_guard lock(_mutex);
+	_enabled = false;
+	_events.clear();
+	_outputPath.clear();
+}
+
+void StartupProfiler::Record(std::string_view name, std::string_view category, std::string_view owner, TraceClock::time_point start, TraceClock::time_point end) {
+	if (!_enabled.load(std::memory_order_relaxed))
+		return;
+
+	TraceEvent event;
+	event.name = name;
+	event.cat = category;
+	event.ts = std::chrono::duration_cast<std::chrono::microseconds>(start - _origin).count();
+	event.dur = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	event.tid = GetTraceThreadId();
+	if (!owner.empty()) {
+		event.args.emplace("plugin", owner);
+	}
+
+	std::lock_guard lock(_mutex);
+	_events.emplace_back(std::move(event));
+}
+
+bool StartupProfiler::Flush() {
+	std::lock_guard lock(_mutex);
+	if (!_enabled || _outputPath.empty())
+		return false;
+	return WriteTraceFile(_outputPath, _events);
+}
+
+ScopedPhase::ScopedPhase(StartupProfiler& profiler, std::string_view name, std::string_view category, std::string_view owner)
+	: _profiler{profiler.IsEnabled() ? &profiler : nullptr}, _name{name}, _category{category}, _owner{owner} {
+	if (_profiler) {
+		_start = TraceClock::now();
+	}
+}
+
+ScopedPhase::~ScopedPhase() {
+	if (_profiler) {
+		_profiler->Record(_name, _category, _owner, _start, TraceClock::now());
+	}
+}
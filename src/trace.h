@@ -0,0 +1,66 @@
+#pragma once
+
+namespace monolm {
+	using TraceClock = std::chrono::steady_clock;
+
+	/// Single complete ("ph": "X") event of the Chrome trace event format.
+	struct TraceEvent {
+		std::string name;
+		std::string cat;
+		std::string ph{ "X" };
+		int64_t ts{}; // microseconds since trace origin
+		int64_t dur{};
+		uint32_t pid{ 1 };
+		uint64_t tid{};
+		std::map<std::string, std::string> args;
+	};
+
+	struct TraceFile {
+		std::vector<TraceEvent> traceEvents;
+		std::string displayTimeUnit{ "ms" };
+	};
+
+	/// Writes events as a Chrome trace file (chrome://tracing, Perfetto, speedscope).
+	bool WriteTraceFile(const fs::path& path, std::vector<TraceEvent> events);
+
+	uint64_t GetTraceThreadId();
+
+	/// Records the duration of every startup phase of the module and its plugins.
+	class StartupProfiler {
+	public:
+		StartupProfiler() = default;
+		~StartupProfiler() = default;
+
+		void Enable(fs::path outputPath);
+		void Disable();
+		bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+		void Record(std::string_view name, std::string_view category, std::string_view owner, TraceClock::time_point start, TraceClock::time_point end);
+		bool Flush();
+
+		const fs::path& GetOutputPath() const { return _outputPath; }
+
+	private:
+		std::atomic<bool> _enabled{ false };
+		fs::path _outputPath;
+		TraceClock::time_point _origin;
+		std::vector<TraceEvent> _events;
+		std::mutex _mutex;
+	};
+
+	class ScopedPhase {
+	public:
+		ScopedPhase(StartupProfiler& profiler, std::string_view name, std::string_view category, std::string_view owner = {});
+		~ScopedPhase();
+
+		ScopedPhase(const ScopedPhase&) = delete;
+		ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	private:
+		StartupProfiler* _profiler;
+		std::string_view _name;
+		std::string_view _category;
+		std::string_view _owner;
+		TraceClock::time_point _start;
+	};
+}
@@ -0,0 +1,373 @@
+// Cross-language call benchmark of the C# (Mono) language module.
+//
+// Usage: mono-lang-module-bench [--root <dir>] [--api <dir>] [--filter <text>] [--iterations <count>] [--json <file>]
+//
+// Loads the cross_call_bench plugin (test/cross_call_bench, build it first) through the headless host.
+// Each case reports nanoseconds per call, managed heap bytes per call and the number of garbage
+// collections triggered while it ran.
+
+#include "host.h"
+
+#include <plugify/compat_format.h>
+#include <plugify/math.h>
+#include <plugify/string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	struct BenchResult {
+		std::string name;
+		uint64_t iterations{};
+		double nsPerCall{};
+		double bytesPerCall{ NAN }; // unknown when a collection ran during the case
+		int64_t gcCount{};
+	};
+
+	/// Native side of the C# -> native cases.
+	int32_t ReverseInt32(int32_t value) { return value; }
+	plg::string ReverseString(const plg::string& value) { return value; }
+	plugify::Vector3 ReverseVector3(const plugify::Vector3& value) { return value; }
+
+	template<typename T>
+	T ReverseValue(T value) { return value; }
+	template<typename T>
+	T ReverseObject(const T& value) { return value; }
+
+	int32_t ReverseStringLength(const plg::string& value) { return static_cast<int32_t>(value.size()); }
+
+	int64_t ReverseSumArrayInt32(const std::vector<int32_t>& values) {
+		int64_t sum = 0;
+		for (int32_t value : values) {
+			sum += value;
+		}
+		return sum;
+	}
+
+	std::vector<int32_t> ReverseMakeArrayInt32(int32_t length) { return std::vector<int32_t>(static_cast<size_t>(length)); }
+
+	void ReverseRefInt32(int32_t& value) { ++value; }
+	void ReverseRefString(plg::string& value) { value = "ref"; }
+	void ReverseRefArrayInt32(std::vector<int32_t>& values) {
+		if (!values.empty()) {
+			++values[0];
+		}
+	}
+
+	int32_t ReverseInvokeCallback(int32_t(*callback)(int32_t), int32_t value) { return callback(value); }
+	void* ReverseGetCallback() { return reinterpret_cast<void*>(&ReverseInt32); }
+
+	template<typename F>
+	void* Address(F* func) { return reinterpret_cast<void*>(func); }
+
+	class Bench {
+	public:
+		Bench(plugify::PluginRef plugin, std::string filter, uint64_t iterations) : _filter{std::move(filter)}, _iterations{iterations} {
+			for (const auto& [method, addr] : plugin.GetMethods()) {
+				_methods.emplace(method.GetName(), addr.RCast<void*>());
+			}
+			_gcCount = Get<int64_t(*)()>("GetGcCount");
+			_heapSize = Get<int64_t(*)()>("GetHeapSize");
+		}
+
+		template<typename F>
+		F Get(std::string_view name) const {
+			auto it = _methods.find(std::string(name));
+			if (it == _methods.end()) {
+				std::cerr << std::format("Method '{}' is not exported by the bench plugin", name) << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+			return reinterpret_cast<F>(it->second);
+		}
+
+		/// Runs fn() iterations / divisor times, fn performs calls calls per invocation.
+		template<typename Fn>
+		void Run(std::string_view name, Fn&& fn, uint64_t divisor = 1, uint64_t calls = 1) {
+			if (!_filter.empty() && name.find(_filter) == std::string_view::npos)
+				return;
+
+			uint64_t iterations = std::max<uint64_t>(_iterations / divisor, 1);
+
+			// Warm up: JIT compilation, thunk creation and caches must not be part of the measurement
+			for (uint64_t i = 0, warmup = std::max<uint64_t>(iterations / 10, 1); i < warmup; ++i) {
+				fn();
+			}
+
+			int64_t gcBefore = _gcCount();
+			int64_t heapBefore = _heapSize();
+			auto start = Clock::now();
+			for (uint64_t i = 0; i < iterations; ++i) {
+				fn();
+			}
+			auto end = Clock::now();
+			int64_t heapAfter = _heapSize();
+			int64_t gcAfter = _gcCount();
+
+			BenchResult result;
+			result.name = name;
+			result.iterations = iterations * calls;
+			result.nsPerCall = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / static_cast<double>(result.iterations);
+			result.gcCount = gcAfter - gcBefore;
+			if (result.gcCount == 0) {
+				result.bytesPerCall = static_cast<double>(std::max<int64_t>(heapAfter - heapBefore, 0)) / static_cast<double>(result.iterations);
+			}
+
+			std::cout << std::format("{:<32} {:>12} {:>12.1f} {:>12} {:>6}", result.name, result.iterations, result.nsPerCall,
+									 std::isnan(result.bytesPerCall) ? std::string("-") : std::format("{:.1f}", result.bytesPerCall), result.gcCount) << std::endl;
+			_results.emplace_back(std::move(result));
+		}
+
+		bool WriteJson(const std::filesystem::path& path) const {
+			std::ofstream stream(path, std::ios::trunc);
+			if (!stream.is_open())
+				return false;
+
+			stream << "[\n";
+			for (size_t i = 0; i < _results.size(); ++i) {
+				const auto& result = _results[i];
+				stream << std::format("\t{{\"name\": \"{}\", \"iterations\": {}, \"nsPerCall\": {:.3f}, \"bytesPerCall\": {}, \"gcCount\": {}}}{}\n",
+									  result.name, result.iterations, result.nsPerCall,
+									  std::isnan(result.bytesPerCall) ? std::string("null") : std::format("{:.3f}", result.bytesPerCall),
+									  result.gcCount, i + 1 < _results.size() ? "," : "");
+			}
+			stream << "]\n";
+			return stream.good();
+		}
+
+	private:
+		std::unordered_map<std::string, void*> _methods;
+		std::vector<BenchResult> _results;
+		std::string _filter;
+		uint64_t _iterations;
+		int64_t(*_gcCount)(){ nullptr };
+		int64_t(*_heapSize)(){ nullptr };
+	};
+
+#if defined(_MSC_VER)
+	const void* volatile g_sink;
+#endif
+
+	/// Keeps the compiler from discarding results of the measured calls.
+	template<typename T>
+	void Consume(const T& value) {
+#if defined(_MSC_VER)
+		// No inline assembly on MSVC, publishing the address forces the value into memory
+		g_sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	void RunNativeToManaged(Bench& bench) {
+		auto noOp = bench.Get<void(*)()>("NoOp");
+		bench.Run("NoOp", [&] { noOp(); });
+
+		auto echoBool = bench.Get<bool(*)(bool)>("EchoBool");
+		bench.Run("EchoBool", [&] { Consume(echoBool(true)); });
+		auto echoChar16 = bench.Get<char16_t(*)(char16_t)>("EchoChar16");
+		bench.Run("EchoChar16", [&] { Consume(echoChar16(u'x')); });
+		auto echoInt32 = bench.Get<int32_t(*)(int32_t)>("EchoInt32");
+		bench.Run("EchoInt32", [&] { Consume(echoInt32(42)); });
+		auto echoInt64 = bench.Get<int64_t(*)(int64_t)>("EchoInt64");
+		bench.Run("EchoInt64", [&] { Consume(echoInt64(42)); });
+		auto echoFloat = bench.Get<float(*)(float)>("EchoFloat");
+		bench.Run("EchoFloat", [&] { Consume(echoFloat(4.2f)); });
+		auto echoDouble = bench.Get<double(*)(double)>("EchoDouble");
+		bench.Run("EchoDouble", [&] { Consume(echoDouble(4.2)); });
+		auto echoPointer = bench.Get<void*(*)(void*)>("EchoPointer");
+		bench.Run("EchoPointer", [&] { Consume(echoPointer(&bench)); });
+
+		auto echoString = bench.Get<plg::string(*)(const plg::string&)>("EchoString");
+		auto stringLength = bench.Get<int32_t(*)(const plg::string&)>("StringLength");
+		for (size_t length : { 0, 16, 256, 4096 }) {
+			plg::string value(length, 'x');
+			bench.Run(std::format("EchoString/{}", length), [&] { Consume(echoString(value)); });
+			bench.Run(std::format("StringLength/{}", length), [&] { Consume(stringLength(value)); });
+		}
+
+		auto sumArrayInt32 = bench.Get<int64_t(*)(const std::vector<int32_t>&)>("SumArrayInt32");
+		auto makeArrayInt32 = bench.Get<std::vector<int32_t>(*)(int32_t)>("MakeArrayInt32");
+		auto echoArrayDouble = bench.Get<std::vector<double>(*)(const std::vector<double>&)>("EchoArrayDouble");
+		auto echoArrayString = bench.Get<std::vector<plg::string>(*)(const std::vector<plg::string>&)>("EchoArrayString");
+		auto refArrayInt32 = bench.Get<void(*)(std::vector<int32_t>&)>("RefArrayInt32");
+		for (uint64_t length : { 1, 1'000, 1'000'000 }) {
+			// Large arrays run fewer iterations to keep the whole suite in the order of seconds
+			uint64_t divisor = std::max<uint64_t>(length / 100, 1);
+			std::vector<int32_t> ints(length, 1);
+			std::vector<double> doubles(length, 1.0);
+			bench.Run(std::format("SumArrayInt32/{}", length), [&] { Consume(sumArrayInt32(ints)); }, divisor);
+			bench.Run(std::format("MakeArrayInt32/{}", length), [&] { Consume(makeArrayInt32(static_cast<int32_t>(length))); }, divisor);
+			bench.Run(std::format("EchoArrayDouble/{}", length), [&] { Consume(echoArrayDouble(doubles)); }, divisor);
+			bench.Run(std::format("RefArrayInt32/{}", length), [&] { refArrayInt32(ints); }, divisor);
+			if (length <= 1'000) {
+				std::vector<plg::string> strings(length, plg::string(16, 'x'));
+				bench.Run(std::format("EchoArrayString/{}", length), [&] { Consume(echoArrayString(strings)); }, divisor);
+			}
+		}
+
+		auto refInt32 = bench.Get<void(*)(int32_t&)>("RefInt32");
+		int32_t refValue = 0;
+		bench.Run("RefInt32", [&] { refInt32(refValue); });
+		auto refString = bench.Get<void(*)(plg::string&)>("RefString");
+		plg::string refText(16, 'x');
+		bench.Run("RefString", [&] { refString(refText); });
+
+		auto echoVector2 = bench.Get<plugify::Vector2(*)(const plugify::Vector2&)>("EchoVector2");
+		bench.Run("EchoVector2", [&] { Consume(echoVector2({ 1, 2 })); });
+		auto echoVector3 = bench.Get<plugify::Vector3(*)(const plugify::Vector3&)>("EchoVector3");
+		bench.Run("EchoVector3", [&] { Consume(echoVector3({ 1, 2, 3 })); });
+		auto echoVector4 = bench.Get<plugify::Vector4(*)(const plugify::Vector4&)>("EchoVector4");
+		bench.Run("EchoVector4", [&] { Consume(echoVector4({ 1, 2, 3, 4 })); });
+		auto echoMatrix4x4 = bench.Get<plugify::Matrix4x4(*)(const plugify::Matrix4x4&)>("EchoMatrix4x4");
+		plugify::Matrix4x4 matrix{};
+		bench.Run("EchoMatrix4x4", [&] { Consume(echoMatrix4x4(matrix)); });
+
+		auto invokeCallback = bench.Get<int32_t(*)(void*, int32_t)>("InvokeCallback");
+		bench.Run("InvokeCallback", [&] { Consume(invokeCallback(reinterpret_cast<void*>(&ReverseInt32), 1)); });
+
+		auto getCallback = bench.Get<void*(*)()>("GetCallback");
+		bench.Run("GetCallback", [&] { Consume(getCallback()); });
+		auto callback = reinterpret_cast<int32_t(*)(int32_t)>(getCallback());
+		bench.Run("CallManagedCallback", [&] { Consume(callback(1)); });
+	}
+
+	/// Same type matrix as RunNativeToManaged, every case makes batch calls from one managed loop.
+	void RunManagedToNative(Bench& bench) {
+		constexpr uint64_t kBatch = 1'000;
+
+		// Large payloads run fewer calls per batch, the total follows the divisor like the native -> C# cases
+		auto run = [&bench](std::string_view name, auto&& fn, uint64_t divisor = 1) {
+			uint64_t batch = std::max<uint64_t>(kBatch / divisor, 1);
+			bench.Run(std::format("Reverse/{}", name), [&] { fn(static_cast<int32_t>(batch)); }, divisor * batch, batch);
+		};
+
+		auto runBool = bench.Get<void(*)(void*, bool, int32_t)>("RunReverseBool");
+		run("Bool", [&](int32_t n) { runBool(Address(&ReverseValue<bool>), true, n); });
+		auto runChar16 = bench.Get<void(*)(void*, char16_t, int32_t)>("RunReverseChar16");
+		run("Char16", [&](int32_t n) { runChar16(Address(&ReverseValue<char16_t>), u'x', n); });
+		auto runInt32 = bench.Get<void(*)(void*, int32_t)>("RunReverseInt32");
+		run("Int32", [&](int32_t n) { runInt32(Address(&ReverseInt32), n); });
+		auto runInt64 = bench.Get<void(*)(void*, int64_t, int32_t)>("RunReverseInt64");
+		run("Int64", [&](int32_t n) { runInt64(Address(&ReverseValue<int64_t>), 42, n); });
+		auto runFloat = bench.Get<void(*)(void*, float, int32_t)>("RunReverseFloat");
+		run("Float", [&](int32_t n) { runFloat(Address(&ReverseValue<float>), 4.2f, n); });
+		auto runDouble = bench.Get<void(*)(void*, double, int32_t)>("RunReverseDouble");
+		run("Double", [&](int32_t n) { runDouble(Address(&ReverseValue<double>), 4.2, n); });
+		auto runPointer = bench.Get<void(*)(void*, void*, int32_t)>("RunReversePointer");
+		run("Pointer", [&](int32_t n) { runPointer(Address(&ReverseValue<void*>), &bench, n); });
+
+		auto runString = bench.Get<void(*)(void*, const plg::string&, int32_t)>("RunReverseString");
+		auto runStringLength = bench.Get<void(*)(void*, const plg::string&, int32_t)>("RunReverseStringLength");
+		for (size_t length : { 0, 16, 256, 4096 }) {
+			plg::string value(length, 'x');
+			run(std::format("String/{}", length), [&](int32_t n) { runString(Address(&ReverseString), value, n); });
+			run(std::format("StringLength/{}", length), [&](int32_t n) { runStringLength(Address(&ReverseStringLength), value, n); });
+		}
+
+		auto runSumArrayInt32 = bench.Get<void(*)(void*, const std::vector<int32_t>&, int32_t)>("RunReverseSumArrayInt32");
+		auto runMakeArrayInt32 = bench.Get<void(*)(void*, int32_t, int32_t)>("RunReverseMakeArrayInt32");
+		auto runArrayDouble = bench.Get<void(*)(void*, const std::vector<double>&, int32_t)>("RunReverseArrayDouble");
+		auto runArrayString = bench.Get<void(*)(void*, const std::vector<plg::string>&, int32_t)>("RunReverseArrayString");
+		auto runRefArrayInt32 = bench.Get<void(*)(void*, const std::vector<int32_t>&, int32_t)>("RunReverseRefArrayInt32");
+		for (uint64_t length : { 1, 1'000, 1'000'000 }) {
+			uint64_t divisor = std::max<uint64_t>(length / 100, 1);
+			std::vector<int32_t> ints(length, 1);
+			std::vector<double> doubles(length, 1.0);
+			run(std::format("SumArrayInt32/{}", length), [&](int32_t n) { runSumArrayInt32(Address(&ReverseSumArrayInt32), ints, n); }, divisor);
+			run(std::format("MakeArrayInt32/{}", length), [&](int32_t n) { runMakeArrayInt32(Address(&ReverseMakeArrayInt32), static_cast<int32_t>(length), n); }, divisor);
+			run(std::format("ArrayDouble/{}", length), [&](int32_t n) { runArrayDouble(Address(&ReverseObject<std::vector<double>>), doubles, n); }, divisor);
+			run(std::format("RefArrayInt32/{}", length), [&](int32_t n) { runRefArrayInt32(Address(&ReverseRefArrayInt32), ints, n); }, divisor);
+			if (length <= 1'000) {
+				std::vector<plg::string> strings(length, plg::string(16, 'x'));
+				run(std::format("ArrayString/{}", length), [&](int32_t n) { runArrayString(Address(&ReverseObject<std::vector<plg::string>>), strings, n); }, divisor);
+			}
+		}
+
+		auto runRefInt32 = bench.Get<void(*)(void*, int32_t)>("RunReverseRefInt32");
+		run("RefInt32", [&](int32_t n) { runRefInt32(Address(&ReverseRefInt32), n); });
+		auto runRefString = bench.Get<void(*)(void*, const plg::string&, int32_t)>("RunReverseRefString");
+		plg::string refText(16, 'x');
+		run("RefString", [&](int32_t n) { runRefString(Address(&ReverseRefString), refText, n); });
+
+		auto runVector2 = bench.Get<void(*)(void*, const plugify::Vector2&, int32_t)>("RunReverseVector2");
+		run("Vector2", [&](int32_t n) { runVector2(Address(&ReverseObject<plugify::Vector2>), { 1, 2 }, n); });
+		auto runVector3 = bench.Get<void(*)(void*, int32_t)>("RunReverseVector3");
+		run("Vector3", [&](int32_t n) { runVector3(Address(&ReverseVector3), n); });
+		auto runVector4 = bench.Get<void(*)(void*, const plugify::Vector4&, int32_t)>("RunReverseVector4");
+		run("Vector4", [&](int32_t n) { runVector4(Address(&ReverseObject<plugify::Vector4>), { 1, 2, 3, 4 }, n); });
+		auto runMatrix4x4 = bench.Get<void(*)(void*, const plugify::Matrix4x4&, int32_t)>("RunReverseMatrix4x4");
+		plugify::Matrix4x4 matrix{};
+		run("Matrix4x4", [&](int32_t n) { runMatrix4x4(Address(&ReverseObject<plugify::Matrix4x4>), matrix, n); });
+
+		auto runInvokeCallback = bench.Get<void(*)(void*, int32_t)>("RunReverseInvokeCallback");
+		run("InvokeCallback", [&](int32_t n) { runInvokeCallback(Address(&ReverseInvokeCallback), n); });
+		auto runGetCallback = bench.Get<void(*)(void*, int32_t)>("RunReverseGetCallback");
+		run("GetCallback", [&](int32_t n) { runGetCallback(Address(&ReverseGetCallback), n); });
+	}
+}
+
+int main(int argc, char* argv[]) {
+	monolm::host::HostOptions options;
+	options.plugins.emplace_back(MONOLM_BENCH_PLUGIN);
+
+	std::string filter;
+	std::filesystem::path jsonPath;
+	uint64_t iterations = 1'000'000;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string_view option(argv[i]);
+		if (option == "--root") {
+			options.rootDir = argv[i + 1];
+		} else if (option == "--api") {
+			options.apiDir = argv[i + 1];
+		} else if (option == "--filter") {
+			filter = argv[i + 1];
+		} else if (option == "--iterations") {
+			iterations = std::stoull(argv[i + 1]);
+		} else if (option == "--json") {
+			jsonPath = argv[i + 1];
+		} else {
+			std::cerr << std::format("Unknown option: {}", option) << std::endl;
+			std::cerr << "Usage: mono-lang-module-bench [--root <dir>] [--api <dir>] [--filter <text>] [--iterations <count>] [--json <file>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	monolm::host::Host host(std::move(options));
+
+	std::string error;
+	if (!host.Start(error)) {
+		std::cerr << error << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Bench bench(*host.FindPlugin("cross_call_bench"), std::move(filter), iterations);
+
+	std::cout << std::format("{:<32} {:>12} {:>12} {:>12} {:>6}", "case", "calls", "ns/call", "bytes/call", "GCs") << std::endl;
+	RunNativeToManaged(bench);
+	RunManagedToNative(bench);
+
+	int result = EXIT_SUCCESS;
+	if (!jsonPath.empty() && !bench.WriteJson(jsonPath)) {
+		std::cerr << std::format("Failed to write results to '{}'", jsonPath.string()) << std::endl;
+		result = EXIT_FAILURE;
+	}
+
+	host.Stop();
+	return result;
+}
@@ -0,0 +1,295 @@
+using System;
+using System.Numerics;
+
+namespace cross_call_bench
+{
+    public delegate int Int32Func(int value);
+    public delegate string StringFunc(string value);
+    public delegate Vector3 Vector3Func(Vector3 value);
+    public delegate bool BoolFunc(bool value);
+    public delegate char Char16Func(char value);
+    public delegate long Int64Func(long value);
+    public delegate float FloatFunc(float value);
+    public delegate double DoubleFunc(double value);
+    public delegate IntPtr PointerFunc(IntPtr value);
+    public delegate int StringLengthFunc(string value);
+    public delegate long SumArrayInt32Func(int[] values);
+    public delegate int[] MakeArrayInt32Func(int length);
+    public delegate double[] ArrayDoubleFunc(double[] values);
+    public delegate string[] ArrayStringFunc(string[] values);
+    public delegate void RefInt32Func(ref int value);
+    public delegate void RefStringFunc(ref string value);
+    public delegate void RefArrayInt32Func(ref int[] values);
+    public delegate Vector2 Vector2Func(Vector2 value);
+    public delegate Vector4 Vector4Func(Vector4 value);
+    public delegate Matrix4x4 Matrix4x4Func(Matrix4x4 value);
+    public delegate int InvokeCallbackFunc(Int32Func callback, int value);
+    public delegate Int32Func GetCallbackFunc();
+
+    /// <summary>
+    /// Methods called by mono-lang-module-bench. Bodies are kept trivial so the measured time is the cost of the bridge.
+    /// </summary>
+    public static class BenchClass
+    {
+        private static readonly Int32Func Callback = value => value + 1;
+
+        public static void NoOp()
+        {
+        }
+
+        public static bool EchoBool(bool value) => value;
+        public static char EchoChar16(char value) => value;
+        public static int EchoInt32(int value) => value;
+        public static long EchoInt64(long value) => value;
+        public static float EchoFloat(float value) => value;
+        public static double EchoDouble(double value) => value;
+        public static IntPtr EchoPointer(IntPtr value) => value;
+
+        public static string EchoString(string value) => value;
+        public static int StringLength(string value) => value.Length;
+
+        public static long SumArrayInt32(int[] values)
+        {
+            long sum = 0;
+            foreach (int value in values)
+            {
+                sum += value;
+            }
+            return sum;
+        }
+
+        public static int[] MakeArrayInt32(int length) => new int[length];
+        public static double[] EchoArrayDouble(double[] values) => values;
+        public static string[] EchoArrayString(string[] values) => values;
+
+        public static void RefInt32(ref int value)
+        {
+            ++value;
+        }
+
+        public static void RefString(ref string value)
+        {
+            value = "ref";
+        }
+
+        public static void RefArrayInt32(ref int[] values)
+        {
+            if (values.Length != 0)
+            {
+                ++values[0];
+            }
+        }
+
+        public static Vector2 EchoVector2(Vector2 value) => value;
+        public static Vector3 EchoVector3(Vector3 value) => value;
+        public static Vector4 EchoVector4(Vector4 value) => value;
+        public static Matrix4x4 EchoMatrix4x4(Matrix4x4 value) => value;
+
+        /// <summary>
+        /// Delegate in: native function pointer marshalled to a managed delegate.
+        /// </summary>
+        public static int InvokeCallback(Int32Func callback, int value) => callback(value);
+
+        /// <summary>
+        /// Delegate out: managed delegate marshalled to a native function pointer.
+        /// </summary>
+        public static Int32Func GetCallback() => Callback;
+
+        public static void RunReverseInt32(Int32Func callback, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(i);
+            }
+        }
+
+        public static void RunReverseString(StringFunc callback, string value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseVector3(Vector3Func callback, int iterations)
+        {
+            var value = new Vector3(1, 2, 3);
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseBool(BoolFunc callback, bool value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseChar16(Char16Func callback, char value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseInt64(Int64Func callback, long value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseFloat(FloatFunc callback, float value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseDouble(DoubleFunc callback, double value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReversePointer(PointerFunc callback, IntPtr value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseStringLength(StringLengthFunc callback, string value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseSumArrayInt32(SumArrayInt32Func callback, int[] value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseMakeArrayInt32(MakeArrayInt32Func callback, int value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseArrayDouble(ArrayDoubleFunc callback, double[] value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseArrayString(ArrayStringFunc callback, string[] value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseVector2(Vector2Func callback, Vector2 value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseVector4(Vector4Func callback, Vector4 value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseMatrix4x4(Matrix4x4Func callback, Matrix4x4 value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(value);
+            }
+        }
+
+        public static void RunReverseRefInt32(RefInt32Func callback, int iterations)
+        {
+            int value = 0;
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(ref value);
+            }
+        }
+
+        public static void RunReverseRefString(RefStringFunc callback, string value, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                string text = value;
+                callback(ref text);
+            }
+        }
+
+        public static void RunReverseRefArrayInt32(RefArrayInt32Func callback, int[] values, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(ref values);
+            }
+        }
+
+        /// <summary>
+        /// Delegate out: managed delegate marshalled to a native function pointer on every call.
+        /// </summary>
+        public static void RunReverseInvokeCallback(InvokeCallbackFunc callback, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback(Callback, i);
+            }
+        }
+
+        /// <summary>
+        /// Delegate in: native function pointer returned to managed code and wrapped in a delegate.
+        /// </summary>
+        public static void RunReverseGetCallback(GetCallbackFunc callback, int iterations)
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                callback();
+            }
+        }
+
+        public static long GetGcCount()
+        {
+            long count = 0;
+            for (int generation = 0; generation <= GC.MaxGeneration; ++generation)
+            {
+                count += GC.CollectionCount(generation);
+            }
+            return count;
+        }
+
+        public static long GetHeapSize() => GC.GetTotalMemory(false);
+    }
+}
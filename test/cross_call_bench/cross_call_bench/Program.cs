@@ -0,0 +1,18 @@
+using System;
+using Plugify;
+
+namespace cross_call_bench
+{
+    public class CrossCallBench : Plugin
+    {
+        public void OnStart()
+        {
+            Console.WriteLine(".Mono: bench OnStart");
+        }
+
+        public void OnEnd()
+        {
+            Console.WriteLine(".Mono: bench OnEnd");
+        }
+    }
+}
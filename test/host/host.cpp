@@ -0,0 +1,256 @@
+#include "host.h"
+
+#include <plugify/compat_format.h>
+#include <plugify/plugify.h>
+#include <plugify/plugin_manager.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+using namespace monolm::host;
+namespace fs = std::filesystem;
+
+namespace {
+	constexpr std::string_view kModuleName = "mono-lang-module";
+
+	class HostLogger final : public plugify::ILogger {
+	public:
+		explicit HostLogger(plugify::Severity severity) : _severity{severity} {}
+
+		void Log(std::string_view message, plugify::Severity severity) override {
+			if (severity <= _severity) {
+				std::cerr << message << std::endl;
+			}
+		}
+
+	private:
+		plugify::Severity _severity;
+	};
+
+	/// Symlinks target at link, copies it where symlinks are not permitted (e.g. Windows without developer mode).
+	bool Link(const fs::path& target, const fs::path& link, std::string& error) {
+		std::error_code ec;
+		fs::remove_all(link, ec); // left over from a previous run in the same root
+		if (fs::is_directory(target)) {
+			fs::create_directory_symlink(target, link, ec);
+		} else {
+			fs::create_symlink(target, link, ec);
+		}
+		if (ec) {
+			ec.clear();
+			fs::copy(target, link, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
+		}
+		if (ec) {
+			error = std::format("Failed to link '{}' to '{}': {}", target.string(), link.string(), ec.message());
+			return false;
+		}
+		return true;
+	}
+
+	/// Finds the plugin assembly next to the manifest or in the output directory of its project.
+	std::optional<fs::path> FindAssembly(const fs::path& manifest, std::string_view entryPoint) {
+		fs::path dir = manifest.parent_path();
+		fs::path stem = manifest.stem();
+		for (const fs::path& candidate : {
+				dir / entryPoint,
+				dir / stem / "bin" / "Release" / entryPoint,
+				dir / stem / "bin" / "Debug" / entryPoint }) {
+			std::error_code ec;
+			if (fs::exists(candidate, ec))
+				return candidate;
+		}
+		return std::nullopt;
+	}
+
+	/// Reads "entryPoint" from a manifest without pulling a JSON parser into the host.
+	std::string ReadEntryPoint(const fs::path& manifest) {
+		std::ifstream stream(manifest);
+		std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		constexpr std::string_view kKey = "\"entryPoint\"";
+		size_t pos = content.find(kKey);
+		if (pos == std::string::npos)
+			return {};
+		size_t begin = content.find('"', content.find(':', pos + kKey.size()));
+		size_t end = begin != std::string::npos ? content.find('"', begin + 1) : std::string::npos;
+		if (end == std::string::npos)
+			return {};
+		return content.substr(begin + 1, end - begin - 1);
+	}
+}
+
+Host::Host(HostOptions options) : _options{std::move(options)} {
+	if (_options.apiDir.empty()) {
+		_options.apiDir = fs::path(MONOLM_HOST_SOURCE_DIR) / "managed" / "Plugify" / "bin" / "Release";
+	}
+}
+
+Host::~Host() {
+	Stop();
+}
+
+bool Host::Start(std::string& error) {
+	if (!Stage(error))
+		return false;
+
+	_plugify = plugify::MakePlugify();
+	_plugify->SetLogger(std::make_shared<HostLogger>(_options.logSeverity));
+	if (!_plugify->Initialize(_rootDir)) {
+		error = std::format("Failed to initialize plugify in '{}'", _rootDir.string());
+		return false;
+	}
+
+	_pluginManager = _plugify->GetPluginManager().lock();
+	if (!_pluginManager || !_pluginManager->Initialize()) {
+		error = "Failed to load plugins";
+		return false;
+	}
+
+	for (const auto& manifest : _options.plugins) {
+		std::string name = manifest.stem().string();
+		if (!FindPlugin(name)) {
+			error = std::format("Plugin '{}' failed to load", name);
+			return false;
+		}
+	}
+
+	return ResolveExports(error);
+}
+
+void Host::Stop() {
+	if (_pluginManager) {
+		_pluginManager->Terminate();
+		_pluginManager.reset();
+	}
+	if (_plugify) {
+		_plugify->Terminate();
+		_plugify.reset();
+	}
+
+	_pumpMainThread = nullptr;
+	_update = nullptr;
+	_fixedUpdate = nullptr;
+	_fixedTime = 0.0;
+
+	if (_tempRoot) {
+		std::error_code ec;
+		fs::remove_all(_rootDir, ec);
+		_tempRoot = false;
+	}
+}
+
+std::optional<plugify::PluginRef> Host::FindPlugin(std::string_view name) const {
+	if (!_pluginManager)
+		return std::nullopt;
+	return _pluginManager->FindPlugin(name);
+}
+
+void Host::Tick(float deltaTime) {
+	// Fixed steps catch up with the elapsed time before the variable update, like the physics step of a game loop
+	if (_fixedUpdate && _options.fixedRate > 0.0) {
+		double step = 1.0 / _options.fixedRate;
+		_fixedTime += deltaTime;
+		while (_fixedTime >= step) {
+			_fixedUpdate(static_cast<float>(step));
+			_fixedTime -= step;
+		}
+	}
+	if (_update) {
+		_update(deltaTime);
+	}
+	if (_pumpMainThread) {
+		_pumpMainThread(0);
+	}
+}
+
+bool Host::Stage(std::string& error) {
+	_rootDir = _options.rootDir;
+	if (_rootDir.empty()) {
+		auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+		_rootDir = fs::temp_directory_path() / std::format("monolm-host-{}", stamp);
+		_tempRoot = true;
+	}
+
+	fs::path moduleDir = _rootDir / "modules" / kModuleName;
+	fs::path pluginsDir = _rootDir / "plugins";
+
+	std::error_code ec;
+	fs::create_directories(moduleDir / "bin", ec);
+	fs::create_directories(pluginsDir, ec);
+	if (ec) {
+		error = std::format("Failed to create '{}': {}", _rootDir.string(), ec.message());
+		return false;
+	}
+
+	std::ofstream config(_rootDir / "plugify.pconfig", std::ios::trunc);
+	config << "{\n\t\"baseDir\": \".\",\n\t\"logSeverity\": \"debug\",\n\t\"repositories\": []\n}\n";
+	if (!config.good()) {
+		error = "Failed to write plugify.pconfig";
+		return false;
+	}
+	config.close();
+
+	fs::path moduleFile(MONOLM_HOST_MODULE_FILE);
+	fs::path sourceDir(MONOLM_HOST_SOURCE_DIR);
+	if (!Link(MONOLM_HOST_MODULE_MANIFEST, moduleDir / std::format("{}.pmodule", kModuleName), error) ||
+		!Link(moduleFile, moduleDir / "bin" / moduleFile.filename(), error) ||
+		!Link(sourceDir / "configs", moduleDir / "configs", error) ||
+		!Link(sourceDir / "mono", moduleDir / "mono", error) ||
+		!Link(_options.apiDir, moduleDir / "api", error))
+		return false;
+
+	for (const auto& manifest : _options.plugins) {
+		std::string entryPoint = ReadEntryPoint(manifest);
+		if (entryPoint.empty()) {
+			error = std::format("Manifest '{}' has no entry point", manifest.string());
+			return false;
+		}
+
+		auto assembly = FindAssembly(manifest, entryPoint);
+		if (!assembly) {
+			error = std::format("Assembly '{}' of '{}' not found, build the plugin first", entryPoint, manifest.string());
+			return false;
+		}
+
+		fs::path pluginDir = pluginsDir / manifest.stem();
+		fs::create_directories(pluginDir, ec);
+		if (!Link(fs::absolute(manifest), pluginDir / manifest.filename(), error) ||
+			!Link(fs::absolute(*assembly), pluginDir / entryPoint, error))
+			return false;
+	}
+
+	return true;
+}
+
+bool Host::ResolveExports(std::string& error) {
+#if defined(_WIN32)
+	HMODULE module = GetModuleHandleW(fs::path(MONOLM_HOST_MODULE_FILE).filename().c_str());
+	if (module) {
+		_pumpMainThread = reinterpret_cast<size_t(*)(uint32_t)>(GetProcAddress(module, "MonoLM_PumpMainThread"));
+		_update = reinterpret_cast<void(*)(float)>(GetProcAddress(module, "MonoLM_Update"));
+		_fixedUpdate = reinterpret_cast<void(*)(float)>(GetProcAddress(module, "MonoLM_FixedUpdate"));
+	}
+#else
+	// The module is already loaded by plugify, only take the handle
+	void* module = dlopen(MONOLM_HOST_MODULE_FILE, RTLD_NOW | RTLD_NOLOAD);
+	if (module) {
+		_pumpMainThread = reinterpret_cast<size_t(*)(uint32_t)>(dlsym(module, "MonoLM_PumpMainThread"));
+		_update = reinterpret_cast<void(*)(float)>(dlsym(module, "MonoLM_Update"));
+		_fixedUpdate = reinterpret_cast<void(*)(float)>(dlsym(module, "MonoLM_FixedUpdate"));
+		dlclose(module);
+	}
+#endif
+	if (!_pumpMainThread || !_update || !_fixedUpdate) {
+		error = "Language module is not loaded or misses MonoLM_* exports";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <plugify/log.h>
+#include <plugify/plugin.h>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace plugify {
+	class IPlugify;
+	class IPluginManager;
+}
+
+namespace monolm::host {
+	struct HostOptions {
+		/// Directory where the plugify layout is staged, a temporary directory is used (and removed) when empty.
+		std::filesystem::path rootDir;
+		/// Directory with the managed Plugify.dll, defaults to the Release output of managed/Plugify.
+		std::filesystem::path apiDir;
+		/// Plugin manifests (.pplugin) to load, the assembly is looked up next to the manifest.
+		std::vector<std::filesystem::path> plugins;
+		plugify::Severity logSeverity{ plugify::Severity::Warning };
+		/// Rate of MonoLM_FixedUpdate in Hz, run from Tick in fixed steps, 0 disables it.
+		double fixedRate{ 50.0 };
+	};
+
+	/// Runs the language module in-process through the plugify core, without an installed plugify setup.
+	/// The module and the given plugins are linked into a staged root directory, then plugify loads them
+	/// the same way a game would: Initialize, OnPluginLoad, OnMethodExport, OnPluginStart.
+	class Host {
+	public:
+		explicit Host(HostOptions options);
+		~Host();
+
+		Host(const Host&) = delete;
+		Host& operator=(const Host&) = delete;
+
+		bool Start(std::string& error);
+		void Stop();
+
+		std::optional<plugify::PluginRef> FindPlugin(std::string_view name) const;
+
+		/// Dispatches the fixed steps due and one tick to the started plugins, then runs jobs posted to the main thread.
+		void Tick(float deltaTime);
+
+		const std::filesystem::path& GetRootDir() const { return _rootDir; }
+
+	private:
+		bool Stage(std::string& error);
+		bool ResolveExports(std::string& error);
+
+	private:
+		HostOptions _options;
+		std::filesystem::path _rootDir;
+		bool _tempRoot{ false };
+		std::shared_ptr<plugify::IPlugify> _plugify;
+		std::shared_ptr<plugify::IPluginManager> _pluginManager;
+		size_t(*_pumpMainThread)(uint32_t){ nullptr };
+		void(*_update)(float){ nullptr };
+		void(*_fixedUpdate)(float){ nullptr };
+		double _fixedTime{ 0.0 }; // tick time not yet consumed by fixed steps
+	};
+}
@@ -0,0 +1,99 @@
+// Headless host of the C# (Mono) language module.
+//
+// Usage: mono-lang-module-host [--root <dir>] [--api <dir>] [--ticks <count>] [--tick-rate <hz>] [--fixed-rate <hz>] [--log <severity>] <manifest.pplugin>...
+//
+// Loads and starts the given plugins, runs the requested number of ticks (MonoLM_FixedUpdate at
+// --fixed-rate, default 50 Hz, MonoLM_Update and the main thread queue) and shuts everything down
+// again. Exits with a non-zero code if any step fails, which makes it usable for smoke and soak
+// tests on machines without a plugify installation.
+
+#include "host.h"
+
+#include <plugify/compat_format.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace {
+	std::optional<plugify::Severity> ParseSeverity(std::string_view name) {
+		if (name == "none") return plugify::Severity::None;
+		if (name == "fatal") return plugify::Severity::Fatal;
+		if (name == "error") return plugify::Severity::Error;
+		if (name == "warning") return plugify::Severity::Warning;
+		if (name == "info") return plugify::Severity::Info;
+		if (name == "debug") return plugify::Severity::Debug;
+		if (name == "verbose") return plugify::Severity::Verbose;
+		return std::nullopt;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	monolm::host::HostOptions options;
+	uint64_t ticks = 0;
+	double tickRate = 0.0;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if (arg == "--root" && hasValue) {
+			options.rootDir = argv[++i];
+		} else if (arg == "--api" && hasValue) {
+			options.apiDir = argv[++i];
+		} else if (arg == "--ticks" && hasValue) {
+			ticks = std::stoull(argv[++i]);
+		} else if (arg == "--tick-rate" && hasValue) {
+			tickRate = std::stod(argv[++i]);
+		} else if (arg == "--fixed-rate" && hasValue) {
+			options.fixedRate = std::stod(argv[++i]);
+		} else if (arg == "--log" && hasValue) {
+			auto severity = ParseSeverity(argv[++i]);
+			if (!severity) {
+				std::cerr << std::format("Unknown severity: {}", argv[i]) << std::endl;
+				return EXIT_FAILURE;
+			}
+			options.logSeverity = *severity;
+		} else if (arg.starts_with("--")) {
+			std::cerr << std::format("Unknown option: {}", arg) << std::endl;
+			return EXIT_FAILURE;
+		} else {
+			options.plugins.emplace_back(arg);
+		}
+	}
+
+	if (options.plugins.empty()) {
+		std::cerr << "Usage: mono-lang-module-host [--root <dir>] [--api <dir>] [--ticks <count>] [--tick-rate <hz>] [--fixed-rate <hz>] [--log <severity>] <manifest.pplugin>..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	monolm::host::Host host(std::move(options));
+
+	std::string error;
+	if (!host.Start(error)) {
+		std::cerr << error << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Without a tick rate the loop runs as fast as possible with a nominal 60 Hz delta
+	auto interval = tickRate > 0.0 ? std::chrono::duration<double>(1.0 / tickRate) : std::chrono::duration<double>::zero();
+	float deltaTime = tickRate > 0.0 ? static_cast<float>(1.0 / tickRate) : 1.0f / 60.0f;
+
+	auto start = std::chrono::steady_clock::now();
+	auto next = start;
+	for (uint64_t i = 0; i < ticks; ++i) {
+		host.Tick(deltaTime);
+		if (interval.count() > 0.0) {
+			next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+			std::this_thread::sleep_until(next);
+		}
+	}
+
+	if (ticks != 0) {
+		auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+		std::cout << std::format("Ran {} ticks in {:.1f} ms", ticks, elapsed.count()) << std::endl;
+	}
+
+	host.Stop();
+	return EXIT_SUCCESS;
+}
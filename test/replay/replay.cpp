@@ -0,0 +1,433 @@
+// Replay of call traces captured by the C# (Mono) language module ("callTrace" setting).
+//
+// Usage: mono-lang-module-replay [--root <dir>] [--api <dir>] [--speed <factor>] [--repeat <count>] [--json <file>] <trace> <manifest.pplugin>...
+//
+// Loads the given plugins through the headless host and calls their exported methods with the recorded
+// arguments in the recorded order, with the recorded ticks in between. Calls run back to back unless a
+// speed is given, --speed 1 reproduces the recorded pacing. All calls are replayed on the main thread, and
+// calls nested in another recorded call are skipped, the outer call makes them again. Pointer and delegate
+// arguments are only valid in the capturing process and are passed as null.
+//
+// Reports the recorded and the replayed nanoseconds per call of every method, so bridge changes can be
+// compared on production shaped load.
+
+#include "host.h"
+
+#include <call_trace.h>
+
+#include <asmjit/asmjit.h>
+#include <plugify/compat_format.h>
+#include <plugify/jit/call.h>
+#include <plugify/method.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+	using namespace monolm;
+	using plugify::JitCall;
+	using plugify::ValueType;
+	namespace ValueUtils = plugify::ValueUtils;
+
+	struct Method {
+		uint32_t id{};
+		ValueType ret{};
+		std::vector<uint8_t> params; // ValueType | trace::kRefFlag
+		std::string plugin;
+		std::string name;
+
+		JitCall::CallingFunc func{ nullptr };
+		uint64_t recordedNs{};
+		uint64_t replayedNs{};
+		uint64_t calls{};
+	};
+
+	struct Event {
+		uint64_t start{};
+		trace::Tag tag{};
+		uint32_t thread{};
+		uint64_t durationNs{};
+		Method* method{ nullptr };
+		float deltaTime{};
+		const char* args{ nullptr }; // into the loaded trace
+		size_t argsSize{};
+	};
+
+	class Trace {
+	public:
+		bool Load(const std::filesystem::path& path, std::string& error) {
+			std::ifstream stream(path, std::ios::binary);
+			if (!stream.is_open()) {
+				error = std::format("Failed to open '{}'", path.string());
+				return false;
+			}
+			_data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+			trace::Reader reader(_data.data(), _data.size());
+			trace::FileHeader header;
+			if (!reader.Read(header) || std::memcmp(header.magic, trace::kMagic, sizeof(header.magic)) != 0) {
+				error = std::format("'{}' is not a call trace", path.string());
+				return false;
+			}
+			if (header.version != trace::kVersion) {
+				error = std::format("'{}' has version {}, expected {}", path.string(), header.version, trace::kVersion);
+				return false;
+			}
+
+			while (reader.Remaining() != 0) {
+				trace::Tag tag;
+				reader.Read(tag);
+				bool valid;
+				switch (tag) {
+					case trace::Tag::Method:
+						valid = ReadMethod(reader);
+						break;
+					case trace::Tag::Call:
+						valid = ReadCall(reader);
+						break;
+					case trace::Tag::Tick:
+						valid = ReadTick(reader);
+						break;
+					default:
+						valid = false;
+						break;
+				}
+				// A capture cut short by a crash ends with a torn record, everything before it is still usable
+				if (!valid) {
+					std::cerr << std::format("Trace is truncated after {} events", _events.size()) << std::endl;
+					break;
+				}
+			}
+
+			std::stable_sort(_events.begin(), _events.end(), [](const Event& a, const Event& b) {
+				return a.start < b.start;
+			});
+			SkipNested();
+			return true;
+		}
+
+		std::unordered_map<uint32_t, std::unique_ptr<Method>>& GetMethods() { return _methods; }
+		const std::vector<Event>& GetEvents() const { return _events; }
+		uint64_t GetNestedCount() const { return _nested; }
+
+	private:
+		bool ReadMethod(trace::Reader& reader) {
+			auto method = std::make_unique<Method>();
+			uint8_t ret, count;
+			if (!reader.Read(method->id) || !reader.Read(ret) || !reader.Read(count))
+				return false;
+			method->ret = static_cast<ValueType>(ret);
+			method->params.resize(count);
+			for (uint8_t& param : method->params) {
+				if (!reader.Read(param))
+					return false;
+			}
+			if (!reader.ReadName(method->plugin) || !reader.ReadName(method->name))
+				return false;
+			_methods[method->id] = std::move(method);
+			return true;
+		}
+
+		bool ReadCall(trace::Reader& reader) {
+			Event event;
+			event.tag = trace::Tag::Call;
+			uint32_t id;
+			if (!reader.Read(id) || !reader.Read(event.thread) || !reader.Read(event.start) || !reader.Read(event.durationNs))
+				return false;
+
+			auto it = _methods.find(id);
+			if (it == _methods.end())
+				return false;
+			event.method = it->second.get();
+
+			// Decoded once to find the end of the arguments, the replay decodes them again into fresh values
+			event.args = reader.GetPosition();
+			for (uint8_t param : event.method->params) {
+				bool valid = true;
+				trace::Visit(static_cast<ValueType>(param & ~trace::kRefFlag), [&]<typename T>(std::type_identity<T>) {
+					T value{};
+					valid = reader.Read(value);
+				});
+				if (!valid)
+					return false;
+			}
+			event.argsSize = static_cast<size_t>(reader.GetPosition() - event.args);
+
+			_events.push_back(event);
+			return true;
+		}
+
+		bool ReadTick(trace::Reader& reader) {
+			Event event;
+			event.tag = trace::Tag::Tick;
+			if (!reader.Read(event.start) || !reader.Read(event.deltaTime))
+				return false;
+			_events.push_back(event);
+			return true;
+		}
+
+		/// Drops calls made while another recorded call was running on the same thread.
+		void SkipNested() {
+			std::unordered_map<uint32_t, uint64_t> busyUntil;
+			std::erase_if(_events, [&](const Event& event) {
+				if (event.tag != trace::Tag::Call)
+					return false;
+				uint64_t& until = busyUntil[event.thread];
+				if (event.start < until) {
+					++_nested;
+					return true;
+				}
+				until = event.start + event.durationNs;
+				return false;
+			});
+		}
+
+		std::string _data;
+		std::unordered_map<uint32_t, std::unique_ptr<Method>> _methods;
+		std::vector<Event> _events;
+		uint64_t _nested{};
+	};
+
+	/// Storage which the callee constructs in place, as for a hidden return parameter. It starts zeroed, which is an
+	/// empty string or vector, because an export that throws returns without constructing it.
+	template<typename T>
+	std::shared_ptr<void> MakeReturnStorage() {
+		return std::shared_ptr<void>(std::calloc(1, sizeof(T)), [](void* ptr) {
+			static_cast<T*>(ptr)->~T();
+			std::free(ptr);
+		});
+	}
+
+	template<typename T>
+	void* Hold(std::vector<std::shared_ptr<void>>& values, T value) {
+		auto ptr = std::make_shared<T>(std::move(value));
+		values.push_back(ptr);
+		return ptr.get();
+	}
+
+	bool Invoke(const Event& event) {
+		Method& method = *event.method;
+		trace::Reader reader(event.args, event.argsSize);
+
+		std::vector<std::shared_ptr<void>> values;
+		bool hasRet = ValueUtils::IsHiddenParam(method.ret);
+		JitCall::Parameters params(hasRet ? method.params.size() + 1 : method.params.size());
+
+		std::shared_ptr<void> retStorage;
+		if (hasRet) {
+			trace::Visit(method.ret, [&]<typename T>(std::type_identity<T>) {
+				retStorage = MakeReturnStorage<T>();
+			});
+			params.AddArgument(retStorage.get());
+		}
+
+		bool valid = true;
+		for (uint8_t param : method.params) {
+			bool ref = (param & trace::kRefFlag) != 0;
+			bool known = trace::Visit(static_cast<ValueType>(param & ~trace::kRefFlag), [&]<typename T>(std::type_identity<T>) {
+				T value{};
+				valid &= reader.Read(value);
+				if constexpr (trace::kPassedByPointer<T>) {
+					params.AddArgument(Hold(values, std::move(value)));
+				} else if (ref) {
+					params.AddArgument(Hold(values, value));
+				} else {
+					params.AddArgument(value);
+				}
+			});
+			if (!known) {
+				params.AddArgument(ref ? Hold<void*>(values, nullptr) : nullptr);
+			}
+		}
+		if (!valid)
+			return false;
+
+		JitCall::Return ret;
+		auto start = Clock::now();
+		method.func(params.GetDataPtr(), &ret);
+		auto end = Clock::now();
+
+		method.replayedNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		method.recordedNs += event.durationNs;
+		++method.calls;
+		return true;
+	}
+
+	/// Binds every recorded method to the export of the loaded plugin, methods with a changed signature are skipped.
+	size_t ResolveMethods(host::Host& host, Trace& trace, std::weak_ptr<asmjit::JitRuntime> rt, std::vector<std::unique_ptr<JitCall>>& calls) {
+		size_t resolved = 0;
+		for (auto& [id, method] : trace.GetMethods()) {
+			auto plugin = host.FindPlugin(method->plugin);
+			if (!plugin) {
+				std::cerr << std::format("Plugin '{}' is not loaded, calls of '{}' are skipped", method->plugin, method->name) << std::endl;
+				continue;
+			}
+
+			for (const auto& [ref, addr] : plugin->GetMethods()) {
+				if (ref.GetName() != method->name)
+					continue;
+
+				std::span<const plugify::PropertyRef> paramProps = ref.GetParamTypes();
+				bool matches = ref.GetReturnType().GetType() == method->ret && paramProps.size() == method->params.size() &&
+							   std::equal(paramProps.begin(), paramProps.end(), method->params.begin(), [](const plugify::PropertyRef& param, uint8_t recorded) {
+								   return (static_cast<uint8_t>(param.GetType()) | (param.IsReference() ? trace::kRefFlag : 0)) == recorded;
+							   });
+				if (!matches) {
+					std::cerr << std::format("Method '{}.{}' changed its signature since the capture, its calls are skipped", method->plugin, method->name) << std::endl;
+					break;
+				}
+
+				auto call = std::make_unique<JitCall>(rt);
+				plugify::MemAddr func = call->GetJitFunc(ref, addr);
+				if (!func) {
+					std::cerr << std::format("Method '{}.{}' has JIT generation error: {}", method->plugin, method->name, call->GetError()) << std::endl;
+					break;
+				}
+				method->func = func.RCast<JitCall::CallingFunc>();
+				calls.push_back(std::move(call));
+				++resolved;
+				break;
+			}
+
+			if (!method->func) {
+				std::cerr << std::format("Method '{}.{}' is not exported, its calls are skipped", method->plugin, method->name) << std::endl;
+			}
+		}
+		return resolved;
+	}
+
+	bool WriteJson(const std::filesystem::path& path, const std::vector<const Method*>& methods) {
+		std::ofstream stream(path, std::ios::trunc);
+		if (!stream.is_open())
+			return false;
+
+		stream << "[\n";
+		for (size_t i = 0; i < methods.size(); ++i) {
+			const Method& method = *methods[i];
+			stream << std::format("\t{{\"name\": \"{}.{}\", \"calls\": {}, \"recordedNsPerCall\": {:.3f}, \"replayedNsPerCall\": {:.3f}}}{}\n",
+								  method.plugin, method.name, method.calls,
+								  static_cast<double>(method.recordedNs) / static_cast<double>(method.calls),
+								  static_cast<double>(method.replayedNs) / static_cast<double>(method.calls),
+								  i + 1 < methods.size() ? "," : "");
+		}
+		stream << "]\n";
+		return stream.good();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	monolm::host::HostOptions options;
+	std::filesystem::path tracePath;
+	std::filesystem::path jsonPath;
+	double speed = 0.0;
+	uint64_t repeat = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if (arg == "--root" && hasValue) {
+			options.rootDir = argv[++i];
+		} else if (arg == "--api" && hasValue) {
+			options.apiDir = argv[++i];
+		} else if (arg == "--speed" && hasValue) {
+			speed = std::stod(argv[++i]);
+		} else if (arg == "--repeat" && hasValue) {
+			repeat = std::max<uint64_t>(std::stoull(argv[++i]), 1);
+		} else if (arg == "--json" && hasValue) {
+			jsonPath = argv[++i];
+		} else if (arg.starts_with("--")) {
+			std::cerr << std::format("Unknown option: {}", arg) << std::endl;
+			return EXIT_FAILURE;
+		} else if (tracePath.empty()) {
+			tracePath = arg;
+		} else {
+			options.plugins.emplace_back(arg);
+		}
+	}
+
+	if (tracePath.empty() || options.plugins.empty()) {
+		std::cerr << "Usage: mono-lang-module-replay [--root <dir>] [--api <dir>] [--speed <factor>] [--repeat <count>] [--json <file>] <trace> <manifest.pplugin>..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Trace trace;
+	std::string error;
+	if (!trace.Load(tracePath, error)) {
+		std::cerr << error << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	monolm::host::Host host(std::move(options));
+	if (!host.Start(error)) {
+		std::cerr << error << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto rt = std::make_shared<asmjit::JitRuntime>();
+	std::vector<std::unique_ptr<JitCall>> calls;
+	if (ResolveMethods(host, trace, rt, calls) == 0) {
+		std::cerr << "No recorded method is exported by the loaded plugins" << std::endl;
+		host.Stop();
+		return EXIT_FAILURE;
+	}
+
+	const std::vector<Event>& events = trace.GetEvents();
+	std::cout << std::format("Replaying {} events ({} nested calls skipped)", events.size(), trace.GetNestedCount()) << std::endl;
+
+	auto start = Clock::now();
+	for (uint64_t i = 0; i < repeat; ++i) {
+		auto origin = Clock::now();
+		uint64_t firstNs = events.empty() ? 0 : events.front().start;
+		for (const Event& event : events) {
+			if (speed > 0.0) {
+				auto offset = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(event.start - firstNs) / speed));
+				std::this_thread::sleep_until(origin + offset);
+			}
+			if (event.tag == trace::Tag::Tick) {
+				host.Tick(event.deltaTime);
+			} else if (event.method->func && !Invoke(event)) {
+				std::cerr << std::format("Arguments of '{}.{}' can not be decoded", event.method->plugin, event.method->name) << std::endl;
+			}
+		}
+	}
+	auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start);
+
+	std::vector<const Method*> methods;
+	for (const auto& [id, method] : trace.GetMethods()) {
+		if (method->calls != 0) {
+			methods.push_back(method.get());
+		}
+	}
+	std::sort(methods.begin(), methods.end(), [](const Method* a, const Method* b) {
+		return a->replayedNs > b->replayedNs;
+	});
+
+	std::cout << std::format("{:<48} {:>10} {:>14} {:>14} {:>8}", "method", "calls", "recorded ns", "replayed ns", "ratio") << std::endl;
+	for (const Method* method : methods) {
+		double recorded = static_cast<double>(method->recordedNs) / static_cast<double>(method->calls);
+		double replayed = static_cast<double>(method->replayedNs) / static_cast<double>(method->calls);
+		std::cout << std::format("{:<48} {:>10} {:>14.1f} {:>14.1f} {:>8.2f}", std::format("{}.{}", method->plugin, method->name),
+								 method->calls, recorded, replayed, recorded > 0.0 ? replayed / recorded : 0.0) << std::endl;
+	}
+	std::cout << std::format("Replayed in {:.1f} ms", elapsed.count()) << std::endl;
+
+	int result = EXIT_SUCCESS;
+	if (!jsonPath.empty() && !WriteJson(jsonPath, methods)) {
+		std::cerr << std::format("Failed to write results to '{}'", jsonPath.string()) << std::endl;
+		result = EXIT_FAILURE;
+	}
+
+	calls.clear();
+	host.Stop();
+	return result;
+}